@@ -0,0 +1,75 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <buzzer.h>
+#include <header.h>
+
+#define AUDIO_FRAME_SAMPLES (AUDIO_SAMPLE_RATE / 60)       // one 60 Hz frame of samples
+#define AUDIO_QUEUE_TARGET (AUDIO_FRAME_SAMPLES * 2)       // frame being played + next one
+
+// -------------------------
+// Audio = sound timer -> SDL_AudioStream
+// -------------------------
+// No audio callback: the frame scheduler pushes samples once per 60 Hz frame and
+// the device thread only drains the stream, so nothing is locked from our side on
+// the audio thread. The queue is kept at about two frames so the buzzer starts
+// on the next frame and stops immediately (the queue is dropped on stop).
+typedef struct {
+    SDL_AudioStream* stream;
+    Buzzer buzzer;
+    bool playing;
+    int16_t samples[AUDIO_QUEUE_TARGET];
+} Audio;
+
+bool audio_init(Audio* a) {
+    a->stream = NULL;
+    a->playing = false;
+    buzzer_init(&a->buzzer);
+
+    if (!SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+        fprintf(stderr, "Audio disabled: %s\n", SDL_GetError());
+        return false;
+    }
+
+    SDL_AudioSpec spec = {SDL_AUDIO_S16, 1, AUDIO_SAMPLE_RATE};
+    a->stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, NULL, NULL);
+    if (!a->stream) {
+        fprintf(stderr, "Audio disabled: %s\n", SDL_GetError());
+        return false;
+    }
+
+    SDL_ResumeAudioStreamDevice(a->stream);
+    return true;
+}
+
+// Called once per 60 Hz frame with (sound_timer > 0)
+void audio_update(Audio* a, bool on) {
+    if (!a->stream) return;
+
+    if (!on) {
+        if (a->playing) {
+            SDL_ClearAudioStream(a->stream);  // cut the tone now, not after the queue drains
+            a->playing = false;
+        }
+        return;
+    }
+
+    a->playing = true;
+    int queued = SDL_GetAudioStreamQueued(a->stream) / (int)sizeof(int16_t);
+    int missing = AUDIO_QUEUE_TARGET - queued;
+    if (missing <= 0) return;
+
+    buzzer_render(&a->buzzer, a->samples, missing, true);
+    SDL_PutAudioStreamData(a->stream, a->samples, missing * sizeof(int16_t));
+}
+
+// Audio still waiting in the stream, in milliseconds (debug readout)
+float audio_queuedMs(Audio* a) {
+    if (!a->stream) return 0.0f;
+    int queued = SDL_GetAudioStreamQueued(a->stream) / (int)sizeof(int16_t);
+    return queued * 1000.0f / AUDIO_SAMPLE_RATE;
+}
+
+void audio_destroy(Audio* a) {
+    if (a->stream) SDL_DestroyAudioStream(a->stream);
+    a->stream = NULL;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <header.h>
+
+#define AUDIO_SAMPLE_RATE 44100
+#define BUZZER_TONE_HZ 440
+#define BUZZER_VOLUME 3000
+#define BUZZER_PERIOD (AUDIO_SAMPLE_RATE / BUZZER_TONE_HZ)  // samples per square-wave cycle
+#define BUZZER_PATTERN_BYTES 16                             // XO-CHIP F002: 128 one-bit samples
+#define BUZZER_PATTERN_BITS (BUZZER_PATTERN_BYTES * 8)
+
+// === Buzzer ===
+// Square wave for the sound timer. One period is computed up front so rendering
+// is just copying out of the table. XO-CHIP ROMs can load a 1-bit pattern
+// instead, played back at 4000 * 2^((pitch - 64) / 48) bits per second.
+typedef struct {
+    int16_t wave[BUZZER_PERIOD];
+    int phase;  // position inside wave[] where the next sample starts
+
+    bool usePattern;
+    uint8_t pattern[BUZZER_PATTERN_BYTES];
+    uint8_t pitch;
+    uint32_t patternStep;   // bits per output sample, 16.16 fixed point
+    uint32_t patternPhase;  // position in the pattern, 16.16 fixed point
+} Buzzer;
+
+void buzzer_init(Buzzer* b) {
+    for (int i = 0; i < BUZZER_PERIOD; i++) {
+        b->wave[i] = (i < BUZZER_PERIOD / 2) ? BUZZER_VOLUME : -BUZZER_VOLUME;
+    }
+    b->phase = 0;
+    b->usePattern = false;
+    b->pitch = 0;
+    b->patternStep = 0;
+    b->patternPhase = 0;
+}
+
+// Once per frame from the interpreter state: `pattern` NULL plays the plain tone
+void buzzer_setPattern(Buzzer* b, const uint8_t* pattern, uint8_t pitch) {
+    b->usePattern = pattern != NULL;
+    if (!pattern) return;
+    memcpy(b->pattern, pattern, BUZZER_PATTERN_BYTES);
+    if (b->patternStep && pitch == b->pitch) return;
+    b->pitch = pitch;
+    double rate = 4000.0 * SDL_pow(2.0, (pitch - 64) / 48.0);
+    b->patternStep = (uint32_t)(rate * 65536.0 / AUDIO_SAMPLE_RATE);
+}
+
+static void buzzer_renderPattern(Buzzer* b, int16_t* out, int count) {
+    const uint32_t wrap = (BUZZER_PATTERN_BITS << 16) - 1;
+    for (int i = 0; i < count; i++) {
+        uint32_t bit = b->patternPhase >> 16;
+        out[i] = (b->pattern[bit >> 3] & (0x80u >> (bit & 7))) ? BUZZER_VOLUME : -BUZZER_VOLUME;
+        b->patternPhase = (b->patternPhase + b->patternStep) & wrap;
+    }
+}
+
+// Write `count` mono samples: the tone while `on`, silence otherwise.
+void buzzer_render(Buzzer* b, int16_t* out, int count, bool on) {
+    if (!on) {
+        memset(out, 0, count * sizeof(out[0]));
+        return;
+    }
+    if (b->usePattern) {
+        buzzer_renderPattern(b, out, count);
+        return;
+    }
+
+    while (count > 0) {
+        int chunk = BUZZER_PERIOD - b->phase;
+        if (chunk > count) chunk = count;
+        memcpy(out, &b->wave[b->phase], chunk * sizeof(out[0]));
+        out += chunk;
+        count -= chunk;
+        b->phase = (b->phase + chunk) % BUZZER_PERIOD;
+    }
+}
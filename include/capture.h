@@ -0,0 +1,182 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <chip8.h>
+#include <header.h>
+
+#define CAPTURE_QUEUE_SIZE 64  // frames in flight between emulation and the writer
+#define CAPTURE_FRAME_PIXELS (HIRES_WIDTH * HIRES_HEIGHT)
+
+// === Frame capture (Y4M) ===
+// Emulation pushes frames into a single-producer/single-consumer ring; a writer
+// thread scales them and streams Y4M (mono luma) to disk. Pushing never waits.
+// A frame identical to the previous one takes no slot: it is counted and sent
+// as a repeat marker on the next entry, and the writer re-emits its last scaled
+// frame that many times. When the ring is full the frame is dropped the same
+// way, so the video keeps its timing and only loses that frame's content.
+typedef struct {
+    uint32_t repeatsBefore;  // copies of the previous frame to write first
+    bool hasPixels;          // false for the final repeat-only marker
+    uint8_t luma[CAPTURE_FRAME_PIXELS];
+} CaptureFrame;
+
+typedef struct {
+    FILE* file;
+    int scale;
+    SDL_Thread* thread;
+    SDL_Semaphore* ready;       // one signal per queued frame, plus one on close
+    SDL_AtomicInt head;         // next slot the writer reads (writer owned)
+    SDL_AtomicInt tail;         // next slot emulation fills (emulation owned)
+    SDL_AtomicInt closing;
+    CaptureFrame queue[CAPTURE_QUEUE_SIZE];
+
+    // emulation side
+    uint8_t previous[CAPTURE_FRAME_PIXELS];
+    bool hasPrevious;
+    uint32_t pendingRepeats;
+    uint32_t pushed, repeated, dropped;
+
+    // writer side
+    uint8_t* scaled;  // one output frame, (128 * scale) x (64 * scale)
+} Capture;
+
+static void capture_writeFrame(Capture* c, const CaptureFrame* frame) {
+    int width = HIRES_WIDTH * c->scale;
+    size_t frameBytes = (size_t)width * HIRES_HEIGHT * c->scale;
+
+    for (uint32_t i = 0; i < frame->repeatsBefore; i++) {
+        fputs("FRAME\n", c->file);
+        fwrite(c->scaled, 1, frameBytes, c->file);
+    }
+    if (!frame->hasPixels) return;
+
+    // Scale one source row, then duplicate it `scale` times
+    for (int y = 0; y < HIRES_HEIGHT; y++) {
+        uint8_t* row = &c->scaled[(y * c->scale) * width];
+        for (int x = 0; x < HIRES_WIDTH; x++) {
+            memset(&row[x * c->scale], frame->luma[y * HIRES_WIDTH + x], c->scale);
+        }
+        for (int r = 1; r < c->scale; r++) {
+            memcpy(row + r * width, row, width);
+        }
+    }
+
+    fputs("FRAME\n", c->file);
+    fwrite(c->scaled, 1, frameBytes, c->file);
+}
+
+static int capture_writerThread(void* data) {
+    Capture* c = data;
+    for (;;) {
+        SDL_WaitSemaphore(c->ready);
+
+        int head = SDL_GetAtomicInt(&c->head);
+        if (head == SDL_GetAtomicInt(&c->tail)) {
+            if (SDL_GetAtomicInt(&c->closing)) break;  // queue drained after close
+            continue;
+        }
+
+        capture_writeFrame(c, &c->queue[(unsigned)head % CAPTURE_QUEUE_SIZE]);
+        SDL_SetAtomicInt(&c->head, head + 1);  // hand the slot back to emulation
+    }
+    return 0;
+}
+
+bool capture_open(Capture* c, const char* filename, int scale) {
+    c->file = fopen(filename, "wb");
+    if (!c->file) {
+        perror("Failed to open capture file");
+        return false;
+    }
+
+    c->scale = scale < 1 ? 1 : scale;
+    c->scaled = calloc((size_t)HIRES_WIDTH * HIRES_HEIGHT * c->scale * c->scale, 1);
+    c->hasPrevious = false;
+    c->pendingRepeats = 0;
+    c->pushed = c->repeated = c->dropped = 0;
+    SDL_SetAtomicInt(&c->head, 0);
+    SDL_SetAtomicInt(&c->tail, 0);
+    SDL_SetAtomicInt(&c->closing, 0);
+
+    // 60 fps progressive, square pixels, 8-bit luma only
+    fprintf(c->file,
+            "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 Cmono\n",
+            HIRES_WIDTH * c->scale,
+            HIRES_HEIGHT * c->scale,
+            TIMER_HZ);
+
+    c->ready = SDL_CreateSemaphore(0);
+    c->thread = SDL_CreateThread(capture_writerThread, "capture", c);
+    return c->scaled && c->ready && c->thread;
+}
+
+// Luma of one RGBA8888 pixel (BT.601 weights), so XO-CHIP colours 1-3 stay distinct
+static inline uint8_t capture_luma(uint32_t pixel) {
+    uint32_t r = pixel >> 24, g = (pixel >> 16) & 0xFF, b = (pixel >> 8) & 0xFF;
+    return (uint8_t)((77 * r + 150 * g + 29 * b) >> 8);
+}
+
+static bool capture_isRepeat(Capture* c, const uint32_t* display) {
+    if (!c->hasPrevious) return false;
+    for (int i = 0; i < CAPTURE_FRAME_PIXELS; i++) {
+        if (capture_luma(display[i]) != c->previous[i]) return false;
+    }
+    return true;
+}
+
+static void capture_publish(Capture* c, int tail) {
+    c->pendingRepeats = 0;
+    SDL_SetAtomicInt(&c->tail, tail + 1);  // hand the slot to the writer
+    SDL_SignalSemaphore(c->ready);
+}
+
+// Queue one presented frame. Never blocks.
+void capture_pushFrame(Capture* c, const uint32_t* display) {
+    c->pushed++;
+    if (capture_isRepeat(c, display)) {
+        c->repeated++;
+        c->pendingRepeats++;
+        return;
+    }
+
+    int tail = SDL_GetAtomicInt(&c->tail);
+    if (tail - SDL_GetAtomicInt(&c->head) == CAPTURE_QUEUE_SIZE) {
+        c->dropped++;
+        c->pendingRepeats++;
+        return;
+    }
+
+    CaptureFrame* frame = &c->queue[(unsigned)tail % CAPTURE_QUEUE_SIZE];
+    for (int i = 0; i < CAPTURE_FRAME_PIXELS; i++) {
+        frame->luma[i] = capture_luma(display[i]);
+    }
+    memcpy(c->previous, frame->luma, CAPTURE_FRAME_PIXELS);
+    c->hasPrevious = true;
+    frame->repeatsBefore = c->pendingRepeats;
+    frame->hasPixels = true;
+    capture_publish(c, tail);
+}
+
+// Drain the queue, stop the writer and close the file
+void capture_close(Capture* c) {
+    if (!c->file) return;
+
+    if (c->thread) {
+        if (c->pendingRepeats > 0) {
+            // Trailing repeats still owe the writer a marker; closing may wait for a slot
+            int tail = SDL_GetAtomicInt(&c->tail);
+            while (tail - SDL_GetAtomicInt(&c->head) == CAPTURE_QUEUE_SIZE) SDL_Delay(1);
+
+            CaptureFrame* frame = &c->queue[(unsigned)tail % CAPTURE_QUEUE_SIZE];
+            frame->repeatsBefore = c->pendingRepeats;
+            frame->hasPixels = false;
+            capture_publish(c, tail);
+        }
+        SDL_SetAtomicInt(&c->closing, 1);
+        SDL_SignalSemaphore(c->ready);
+        SDL_WaitThread(c->thread, NULL);
+    }
+    if (c->ready) SDL_DestroySemaphore(c->ready);
+    free(c->scaled);
+    fclose(c->file);
+    c->file = NULL;
+}
@@ -1,16 +1,65 @@
+#pragma once
 #include <header.h>
+#include <input.h>
+#include <opcodes.h>
+#include <romdb.h>
+#include <trace.h>
 
-#define MEM_SIZE 4096
-#define DISPLAY_WIDTH 64
+#define MEM_SIZE 0x10000  // XO-CHIP address space; CHIP-8 ROMs only touch the first 4 KB
+#define DISPLAY_WIDTH 64    // lores (CHIP-8) resolution
 #define DISPLAY_HEIGHT 32
+#define HIRES_WIDTH 128     // SUPER-CHIP 00FF resolution, and the size chip8_render outputs
+#define HIRES_HEIGHT 64
+#define DISPLAY_WORDS (HIRES_WIDTH / 64)  // uint64_t per display row
+#define DISPLAY_PLANES 2                  // XO-CHIP bitplanes, selected with FN01
+#define ALL_PLANES ((1u << DISPLAY_PLANES) - 1)
+#define AUDIO_PATTERN_SIZE 16             // XO-CHIP F002: 128 one-bit samples
 #define STACK_SIZE 16
 #define KEYPAD_SIZE 16
 #define FONTSET_SIZE 80
 #define FONTSET_START_ADDRESS 0x50
+#define BIG_FONTSET_SIZE 160
+#define BIG_FONTSET_START_ADDRESS 0xA0  // SUPER-CHIP 8x10 digits, right after the small font
+#define CHIP8_HZ 500  // default instructions per second; a ROM's profile may change it
+#define TIMER_HZ 60   // delay/sound timer rate (one "frame")
+
+// chip8Cycle disassembles every instruction, and prints the screen after every
+// DXYN, to stdout. Tools that run a lot of instructions define CHIP8_QUIET
+// before including this header; a CHIP8_TRACE build (make TRACE=1) logs
+// binary records instead (see trace.h).
+#if defined(CHIP8_QUIET) || defined(CHIP8_TRACE)
+#define CHIP8_LOG(...) ((void)0)
+#else
+#define CHIP8_LOG(...) printf(__VA_ARGS__)
+#endif
+
+// Opcode-family counters (see opcodes.h). Without CHIP8_PROFILE_OPCODES these
+// expand to nothing and chip8Cycle is the plain interpreter.
+#ifdef CHIP8_PROFILE_OPCODES
+#define CHIP8_COUNT(family) (profiledFamily = (family), chip8->opcodeProfile.count[family]++)
+#else
+#define CHIP8_COUNT(family) ((void)0)
+#endif
+
+// === Faults ===
+// What a ROM did that no real machine survives. The instance stops; the
+// process and every other instance carry on.
+// X(fault, description)
+#define CHIP8_FAULTS(X)                                          \
+    X(NONE, "no fault")                                          \
+    X(STACK_OVERFLOW, "stack overflow (CALL with a full stack)") \
+    X(STACK_UNDERFLOW, "stack underflow (RET with an empty stack)")
+
+#define CHIP8_FAULT_ENUM(fault, description) CHIP8_FAULT_##fault,
+#define CHIP8_FAULT_NAME(fault, description) description,
+
+typedef enum { CHIP8_FAULTS(CHIP8_FAULT_ENUM) CHIP8_FAULT_COUNT } Chip8Fault;
+
+static const char* const chip8FaultNames[CHIP8_FAULT_COUNT] = {CHIP8_FAULTS(CHIP8_FAULT_NAME)};
 
 // === CHIP-8 State ===
-typedef struct {
-    uint8_t memory[MEM_SIZE];                          // 4KB Memory
+typedef struct Chip8 {
+    uint8_t memory[MEM_SIZE];                          // 64KB Memory (4KB for plain CHIP-8)
     uint8_t V[16];                                     // 16 8-bits Registers V0-VF
     uint16_t index;                                    // Index Register (16 bit)
     uint16_t pc;                                       // Program Counter (starts at 0x200)
@@ -18,15 +67,165 @@ typedef struct {
     uint8_t sp;                                        // Stack Pointer
     uint8_t delay_timer;                               // Delay Timer (8 bit timer)
     uint8_t sound_timer;                               // Sound Timer (8 bit timer)
-    uint32_t display[DISPLAY_WIDTH * DISPLAY_HEIGHT];  // Display (64x32 pixels)
-    uint8_t keypad[KEYPAD_SIZE];                       // Input (16 keys)
+    uint8_t audioPattern[AUDIO_PATTERN_SIZE];          // XO-CHIP F002 waveform, MSB first
+    bool hasAudioPattern;                              // else the sound timer plays the plain buzzer
+    uint8_t pitch;                                     // XO-CHIP FX3A, 64 = 4000 samples/s
+    uint64_t display[DISPLAY_PLANES][HIRES_HEIGHT][DISPLAY_WORDS];  // Bitplanes (see "Display")
+    bool hires;                                        // 128x64 after 00FF, 64x32 after 00FE
+    uint8_t planes;                                    // Planes DXYN/CLS/scrolls act on (FN01)
+    uint16_t keys;                                     // Keypad: bit k set while key k is down
+    InputQueue input;                                  // Key events waiting for their clock
+    uint64_t clock;                                    // Instruction slots since chip8_init
+    uint8_t rpl[16];                                   // SUPER-CHIP RPL user flags (FX75/FX85)
+    bool waitingForKey;                                // FX0A parked the CPU until a key is down
+    uint8_t waitingRegister;                           // Vx that receives the key once it arrives
+    bool waitingForVblank;                             // DXYN parked the CPU until the next timer tick
+    uint32_t rng;                                      // CXKK state, per instance so runs are reproducible
+    Chip8Profile profile;                              // Picked from the ROM database on load
+    uint8_t quirks;                                    // CHIP8_QUIRK_* of that profile
+    uint16_t hz;                                       // Instructions per second
+    Chip8Fault (*cycle)(struct Chip8* chip8);          // chip8Cycle specialised for those quirks
+    Chip8Fault fault;                                  // Last fault, CHIP8_FAULT_NONE until one happens
+    uint16_t faultPc;                                  // Address of the instruction that raised it
+#ifdef CHIP8_PROFILE_OPCODES
+    Chip8OpcodeProfile opcodeProfile;                  // Per-family counters / sampled timings
+#endif
+#ifdef CHIP8_TRACE
+    TraceLog* trace;                                   // Instruction records go here; NULL = off
+#endif
 } Chip8;
 
+// === Display ===
+// One bit per pixel, packed MSB first: pixel (x, y) of a plane is bit
+// 63 - x % 64 of display[plane][y][x / 64]. The active screen is the top-left
+// width x height corner, so lores uses word 0 of rows 0..31 and everything past
+// it stays zero. Sprite rows are XORed in a word at a time and scrolls move
+// whole rows, so hires costs no more than lores. Plane 0 is the only one plain
+// CHIP-8 and SUPER-CHIP draw to; XO-CHIP selects planes with FN01, and a
+// pixel's colour is its plane bits. chip8_render expands the planes for a texture.
+static inline int chip8_displayWidth(const Chip8* chip8) {
+    return chip8->hires ? HIRES_WIDTH : DISPLAY_WIDTH;
+}
+
+static inline int chip8_displayHeight(const Chip8* chip8) {
+    return chip8->hires ? HIRES_HEIGHT : DISPLAY_HEIGHT;
+}
+
+// Colour 0..3: bit 0 from plane 0, bit 1 from plane 1
+static inline uint8_t chip8_pixel(const Chip8* chip8, int x, int y) {
+    unsigned bit = 63 - (x & 63);
+    return ((chip8->display[0][y][x >> 6] >> bit) & 1) | (((chip8->display[1][y][x >> 6] >> bit) & 1) << 1);
+}
+
+void chip8_clearDisplay(Chip8* chip8, uint8_t planes) {
+    for (int plane = 0; plane < DISPLAY_PLANES; plane++) {
+        if (planes & (1u << plane)) memset(chip8->display[plane], 0, sizeof(chip8->display[plane]));
+    }
+}
+
+// === Sprite blitter ===
+// Where a sprite's columns land is the same for every row, so DXYN works it
+// out once: the word holding column x, the word its overflow goes to and a
+// mask that keeps or drops that overflow. A row is then two shifts, two ANDs
+// and two XORs whatever its position. Widths are whole words, so the word
+// after the last is word 0 again: wrapping is `& (words - 1)`, and at 64
+// pixels the shift pair is a rotate within the one word.
+typedef struct {
+    unsigned word, next;  // word holding column x, word the overflow lands in
+    unsigned shift;       // x within `word`
+    uint64_t spill;       // ~0 keeps the overflow, 0 clips it at the right edge
+} Chip8Blit;
+
+static inline Chip8Blit chip8_blitSetup(const Chip8* chip8, unsigned x, bool clip) {
+    unsigned words = chip8_displayWidth(chip8) / 64;
+    Chip8Blit b;
+    b.word = x >> 6;
+    b.next = (b.word + 1) & (words - 1);
+    b.shift = x & 63;
+    b.spill = clip ? -(uint64_t)(b.word + 1 < words) : ~0ull;
+    return b;
+}
+
+// XOR one sprite row (`bits` MSB first, 8 or 16 pixels used) into row `y` of
+// `plane`. Returns true if a lit pixel was turned off.
+static inline bool chip8_blitRow(Chip8* chip8, unsigned plane, const Chip8Blit* b, unsigned y, uint16_t bits) {
+    uint64_t* row = chip8->display[plane][y];
+    uint64_t sprite = (uint64_t)bits << 48;
+    uint64_t left = sprite >> b->shift;
+    uint64_t right = (sprite << 1 << (63 - b->shift)) & b->spill;  // in two steps: shift 0 spills nothing
+    bool collision = (row[b->word] & left) | (row[b->next] & right);
+    row[b->word] ^= left;
+    row[b->next] ^= right;
+    return collision;
+}
+
+// 00CN/00DN: down (n > 0) or up (n < 0) by |n| rows of the current
+// resolution, on the selected planes
+void chip8_scrollVertical(Chip8* chip8, int n) {
+    unsigned height = chip8_displayHeight(chip8);
+    unsigned rows = (unsigned)(n < 0 ? -n : n);
+    if (rows > height) rows = height;
+    size_t rowBytes = sizeof(chip8->display[0][0]);
+
+    for (int plane = 0; plane < DISPLAY_PLANES; plane++) {
+        if (!(chip8->planes & (1u << plane))) continue;
+        uint64_t(*rowsOf)[DISPLAY_WORDS] = chip8->display[plane];
+        if (n > 0) {
+            memmove(rowsOf[rows], rowsOf[0], (height - rows) * rowBytes);
+            memset(rowsOf[0], 0, rows * rowBytes);
+        } else {
+            memmove(rowsOf[0], rowsOf[rows], (height - rows) * rowBytes);
+            memset(rowsOf[height - rows], 0, rows * rowBytes);
+        }
+    }
+}
+
+// 00FB/00FC: 4 pixels right or left, a shift across each row's words
+void chip8_scrollHorizontal(Chip8* chip8, bool right) {
+    unsigned words = chip8_displayWidth(chip8) / 64;
+    for (int plane = 0; plane < DISPLAY_PLANES; plane++) {
+        if (!(chip8->planes & (1u << plane))) continue;
+        for (int y = 0; y < chip8_displayHeight(chip8); y++) {
+            uint64_t* row = chip8->display[plane][y];
+            if (right) {
+                for (unsigned i = words; i-- > 0;) row[i] = (row[i] >> 4) | (i ? row[i - 1] << 60 : 0);
+            } else {
+                for (unsigned i = 0; i < words; i++) row[i] = (row[i] << 4) | (i + 1 < words ? row[i + 1] >> 60 : 0);
+            }
+        }
+    }
+}
+
+// RGBA8888 per colour: off, plane 0, plane 1, both
+static const uint32_t chip8Palette[1u << DISPLAY_PLANES] = {0x00000000, 0xFFFFFFFF, 0xAAAAAAFF, 0x555555FF};
+
+// Expand to HIRES_WIDTH x HIRES_HEIGHT 32-bit pixels (lores pixels doubled),
+// for a streaming texture or a video frame
+void chip8_render(const Chip8* chip8, uint32_t* pixels) {
+    int scale = chip8->hires ? 1 : 2;
+    for (int y = 0; y < HIRES_HEIGHT; y++) {
+        uint32_t* out = &pixels[y * HIRES_WIDTH];
+        for (int x = 0; x < HIRES_WIDTH; x++) {
+            out[x] = chip8Palette[chip8_pixel(chip8, x / scale, y / scale)];
+        }
+    }
+}
+
+// Current resolution as is, chip8_displayWidth x chip8_displayHeight pixels,
+// for the CPU upscaler
+void chip8_renderNative(const Chip8* chip8, uint32_t* pixels) {
+    int width = chip8_displayWidth(chip8);
+    for (int y = 0; y < chip8_displayHeight(chip8); y++) {
+        for (int x = 0; x < width; x++) {
+            pixels[y * width + x] = chip8Palette[chip8_pixel(chip8, x, y)];
+        }
+    }
+}
+
 void dumpDisplay(Chip8* chip8) {
-    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
-        for (int x = 0; x < DISPLAY_WIDTH; x++) {
-            uint32_t pixel = chip8->display[y * DISPLAY_WIDTH + x];
-            putchar(pixel ? '#' : '.');  // '#' = ON, '.' = OFF
+    for (int y = 0; y < chip8_displayHeight(chip8); y++) {
+        for (int x = 0; x < chip8_displayWidth(chip8); x++) {
+            putchar(".#o@"[chip8_pixel(chip8, x, y)]);  // '.' = OFF, '#' = plane 0, 'o' = plane 1, '@' = both
         }
         putchar('\n');
     }
@@ -35,6 +234,21 @@ void dumpDisplay(Chip8* chip8) {
 
 void chip8_screen_init() {}
 
+// One interpreter per profile, generated below from CHIP8_PROFILES (see "Interpreter")
+#define CHIP8_CYCLE_DECLARE(profile, quirks, hz, description) Chip8Fault chip8Cycle_##profile(Chip8* chip8);
+#define CHIP8_CYCLE_ENTRY(profile, quirks, hz, description) chip8Cycle_##profile,
+CHIP8_PROFILES(CHIP8_CYCLE_DECLARE)
+static Chip8Fault (*const chip8CycleVariants[CHIP8_PROFILE_COUNT])(Chip8*) = {CHIP8_PROFILES(CHIP8_CYCLE_ENTRY)};
+
+// hz 0 keeps the profile's own rate. This is where the interpreter variant
+// is picked, so nothing per instruction looks at the quirks.
+void chip8_setProfile(Chip8* chip8, Chip8Profile profile, uint16_t hz) {
+    chip8->profile = profile;
+    chip8->quirks = chip8Profiles[profile].quirks;
+    chip8->hz = hz ? hz : chip8Profiles[profile].hz;
+    chip8->cycle = chip8CycleVariants[profile];
+}
+
 void chip8_init(Chip8* chip8) {
     memset(chip8->memory, 0, MEM_SIZE * sizeof(chip8->memory[0]));
     memset(chip8->V, 0, 16);
@@ -42,10 +256,31 @@ void chip8_init(Chip8* chip8) {
     chip8->pc = 0x200;
     memset(chip8->stack, 0, STACK_SIZE * sizeof(chip8->stack[0]));
     chip8->sp = 0;
+    chip8->fault = CHIP8_FAULT_NONE;
+    chip8->faultPc = 0;
     chip8->delay_timer = 0;
     chip8->sound_timer = 0;
-    memset(chip8->display, 0, DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(chip8->display[0]));
-    memset(chip8->keypad, 0, KEYPAD_SIZE * sizeof(chip8->keypad[0]));
+    chip8_clearDisplay(chip8, ALL_PLANES);
+    chip8->hires = false;
+    chip8->planes = 1;
+    memset(chip8->audioPattern, 0, sizeof(chip8->audioPattern));
+    chip8->hasAudioPattern = false;
+    chip8->pitch = 64;
+    chip8->keys = 0;
+    input_init(&chip8->input);
+    chip8->clock = 0;
+    memset(chip8->rpl, 0, sizeof(chip8->rpl));
+    chip8->waitingForKey = false;
+    chip8->waitingRegister = 0;
+    chip8->waitingForVblank = false;
+    chip8_setProfile(chip8, CHIP8_PROFILE_DEFAULT, 0);
+    chip8->rng = 0x2545F491;
+#ifdef CHIP8_PROFILE_OPCODES
+    memset(&chip8->opcodeProfile, 0, sizeof(chip8->opcodeProfile));
+#endif
+#ifdef CHIP8_TRACE
+    chip8->trace = NULL;
+#endif
 
     static const uint8_t chip8_fontset[80] = {
         0xF0, 0x90, 0x90, 0x90, 0xF0,  // 0
@@ -66,106 +301,123 @@ void chip8_init(Chip8* chip8) {
         0xF0, 0x80, 0xF0, 0x80, 0x80   // F
     };
 
-    memcpy(&chip8->memory[0x50], chip8_fontset, sizeof(chip8_fontset));
-}
+    static const uint8_t chip8_bigFontset[BIG_FONTSET_SIZE] = {
+        0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF,  // 0
+        0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF,  // 1
+        0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,  // 2
+        0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,  // 3
+        0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03,  // 4
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,  // 5
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,  // 6
+        0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18,  // 7
+        0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,  // 8
+        0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,  // 9
+        0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3,  // A
+        0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC,  // B
+        0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C,  // C
+        0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC,  // D
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,  // E
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0   // F
+    };
 
-long getRomSize(const char* filename) {
-    FILE* rom = fopen(filename, "rb");
-    if (!rom) {
-        perror("Failed to open ROM");
-        return -1;
-    }
-    fseek(rom, 0, SEEK_END);
-    long size = ftell(rom);
-    fclose(rom);
-    return size;
+    memcpy(&chip8->memory[FONTSET_START_ADDRESS], chip8_fontset, sizeof(chip8_fontset));
+    memcpy(&chip8->memory[BIG_FONTSET_START_ADDRESS], chip8_bigFontset, sizeof(chip8_bigFontset));
+    opcodes_init();
 }
 
-int romLoaderHasMaloc(Chip8* chip8, const char* filename) {
-    FILE* rom = fopen(filename, "rb");
-    if (!rom) {
-        perror("Failed to open ROM");
-        return -1;
-    }
-
-    fseek(rom, 0, SEEK_END);
-    size_t size = ftell(rom);
-    fseek(rom, 0, SEEK_SET);
+// === ROM loading ===
+// Every source ends in chip8_loadBuffer: the size is checked once there and
+// the ROM lands in memory[0x200] with a single memcpy. Files are mapped
+// rather than read, so a corpus run over the same ROMs copies straight out
+// of the page cache. Loaders return the ROM size, or -1 on error.
+#define ROM_START 0x200
+#define ROM_MAX_SIZE (MEM_SIZE - ROM_START)
 
-    // Make sure it fits into CHIP-8 memory (size + 0x200 <= 4096)
-    if (size > (4096 - 0x200)) {
-        fprintf(stderr, "ROM too large to fit in memory.\n");
-        fclose(rom);
-        return -1;
+// Content hash that identifies a ROM (FNV-1a, 64 bit)
+uint64_t rom_hash(const uint8_t* rom, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= rom[i];
+        hash *= 0x100000001B3ull;
     }
+    return hash;
+}
 
-    unsigned char* buffer = malloc(size);
-    if (!buffer) {
-        perror("Failed to allocate buffer");
-        fclose(rom);
+int chip8_loadBuffer(Chip8* chip8, const uint8_t* rom, size_t size) {
+    if (!rom && size) {
+        fprintf(stderr, "Invalid ROM data\n");
         return -1;
     }
-
-    size_t bytesRead = fread(buffer, 1, size, rom);
-    if (bytesRead != size) {
-        perror("Failed to read ROM completely");
-        free(buffer);
-        fclose(rom);
+    if (size > ROM_MAX_SIZE) {
+        fprintf(stderr, "ROM too large to fit in memory.\n");
         return -1;
     }
+    if (size) memcpy(&chip8->memory[ROM_START], rom, size);
 
-    // Load into memory starting at 0x200
-    for (size_t i = 0; i < size; i++) {
-        chip8->memory[0x200 + i] = buffer[i];
+    // Known ROM: its quirks and speed, so batch runs need no per-ROM flags
+    const RomDbEntry* known = romdb_lookup(rom_hash(rom, size));
+    if (known) {
+        chip8_setProfile(chip8, known->profile, known->hz);
+        CHIP8_LOG("%s: %s profile, %u Hz\n", known->name, chip8Profiles[chip8->profile].name, chip8->hz);
     }
+    CHIP8_LOG("Load successfully.\n");
+    return (int)size;
+}
 
-    free(buffer);
-    fclose(rom);
-    printf("Load successfully.\n");
-    return 1;
-};
+// Read-only view of a whole file (Win32 file mapping)
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    HANDLE file;
+    HANDLE mapping;
+} RomMapping;
 
-int romLoaderNoMaloc(Chip8* chip8, const char* filename) {
-    FILE* rom = fopen(filename, "rb");
-    if (!rom) {
-        perror("Failed to open ROM");
-        return -1;
-    }
-    fseek(rom, 0, SEEK_END);
-    size_t size = ftell(rom);
-    fseek(rom, 0, SEEK_SET);
+void rom_unmap(RomMapping* m) {
+    if (m->data) UnmapViewOfFile(m->data);
+    if (m->mapping) CloseHandle(m->mapping);
+    if (m->file != INVALID_HANDLE_VALUE) CloseHandle(m->file);
+    m->data = NULL;
+    m->mapping = NULL;
+    m->file = INVALID_HANDLE_VALUE;
+}
 
-    // Make sure it fits into CHIP-8 memory (size + 0x200 <= 4096)
-    if (size > (4096 - 0x200)) {
-        fprintf(stderr, "ROM too large to fit in memory.\n");
-        fclose(rom);
-        return -1;
+bool rom_map(RomMapping* m, const char* filename) {
+    m->data = NULL;
+    m->size = 0;
+    m->mapping = NULL;
+    m->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m->file == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Failed to open ROM: %s\n", filename);
+        return false;
     }
 
-    // Read ROM directly into CHIP-8 memory
-    size_t bytesRead = fread(&chip8->memory[0x200], 1, size, rom);
-    if (bytesRead != size) {
-        perror("Failed to read ROM completely");
-        fclose(rom);
-        return -1;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m->file, &size)) {
+        fprintf(stderr, "Failed to read ROM size: %s\n", filename);
+        rom_unmap(m);
+        return false;
     }
+    m->size = (size_t)size.QuadPart;
+    if (m->size == 0) return true;  // nothing to map; an empty view is not allowed
 
-    fclose(rom);
-    printf("Load successfully.\n");
-    return 1;
-};
-
-int romLoaderTest(Chip8* chip8, const uint8_t* rom, size_t romSize) {
-    if (!rom) {
-        fprintf(stderr, "Invalid ROM data\n");
-        return -1;
+    m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m->mapping) m->data = MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m->data) {
+        fprintf(stderr, "Failed to map ROM: %s\n", filename);
+        rom_unmap(m);
+        return false;
     }
+    return true;
+}
 
-    // Read ROM directly into CHIP-8 memory
-    memcpy(&chip8->memory[0x200], rom, romSize);
-    printf("Load successfully.\n");
-    return 1;
-};
+int chip8_loadFile(Chip8* chip8, const char* filename) {
+    RomMapping rom;
+    if (!rom_map(&rom, filename)) return -1;
+    int size = chip8_loadBuffer(chip8, rom.data, rom.size);
+    rom_unmap(&rom);
+    return size;
+}
 
 void debug_dump_memory(uint8_t* memory, int start, int length) {
     for (int i = 0; i < length; i += 16) {
@@ -204,15 +456,118 @@ void dumpRegisters(Chip8* chip8) {
     printf("=====================\n");
 }
 
-void chip8Cycle(Chip8* chip8) {
-    if (chip8->pc >= MEM_SIZE - 2) {
-        printf("PC out of bounds! %04X\n", chip8->pc);
-        exit(1);
+// 60 Hz timer tick, driven by the frontend's frame scheduler
+void chip8_tickTimers(Chip8* chip8) {
+    if (chip8->delay_timer > 0) --chip8->delay_timer;
+    if (chip8->sound_timer > 0) --chip8->sound_timer;
+    chip8->waitingForVblank = false;
+}
+
+// Complete a pending FX0A if any key is down (lowest key wins).
+// Returns true once the CPU is free to run again.
+bool chip8_resolveKeyWait(Chip8* chip8) {
+    if (!chip8->waitingForKey) return true;
+    if (!chip8->keys) return false;
+
+    chip8->V[chip8->waitingRegister] = (uint8_t)__builtin_ctz(chip8->keys);
+    chip8->waitingForKey = false;
+    return true;
+}
+
+// Key change taking effect `clock` instruction slots after chip8_init (pass
+// chip8->clock for "now"). False if the queue is full and it was dropped.
+bool chip8_queueKey(Chip8* chip8, uint64_t clock, uint8_t key, bool down) {
+    return input_push(&chip8->input, clock, key, down);
+}
+
+// Apply the key events that are due: one compare while none are
+static inline __attribute__((always_inline)) void chip8_pollInput(Chip8* chip8) {
+    if (chip8->clock >= chip8->input.next) input_apply(&chip8->input, chip8->clock, &chip8->keys);
+}
+
+// Bytes a taken skip jumps over: with CHIP8_QUIRK_LONG_SKIP, F000 NNNN counts
+// as one 4-byte instruction. Without it this is the constant 2.
+static inline __attribute__((always_inline)) uint16_t chip8_skipLength(const Chip8* chip8, const uint8_t quirks) {
+    if (!(quirks & CHIP8_QUIRK_LONG_SKIP)) return 2;
+    bool longLoad = chip8->memory[chip8->pc] == 0xF0 && chip8->memory[(chip8->pc + 1) & (MEM_SIZE - 1)] == 0x00;
+    return longLoad ? 4 : 2;
+}
+
+// Record a fault and leave PC on the faulting instruction, which has not
+// changed any state, so running on just raises the same fault again.
+static Chip8Fault chip8_fault(Chip8* chip8, Chip8Fault fault) {
+    chip8->pc -= 2;
+    chip8->fault = fault;
+    chip8->faultPc = chip8->pc;
+    return fault;
+}
+
+#ifdef CHIP8_TRACE
+// Append one record. The changed register is the lowest Vx that differs
+// from `before`, VF only if nothing else changed (flags ride along with a
+// result), then I.
+static inline void chip8_trace(Chip8* chip8, uint16_t pc, uint16_t opcode, const uint64_t before[2],
+                               uint16_t index, Chip8Fault fault) {
+    uint64_t after[2];
+    memcpy(after, chip8->V, sizeof(after));
+    uint64_t low = before[0] ^ after[0], high = before[1] ^ after[1];  // byte k = V[k] (little-endian)
+    TraceRecord record = {chip8->clock, pc, opcode, TRACE_REG_NONE, (uint8_t)fault, 0};
+    if (low | (high & 0x00FFFFFFFFFFFFFFull)) {
+        record.reg = (uint8_t)(low ? __builtin_ctzll(low) / 8 : 8 + __builtin_ctzll(high) / 8);
+    } else if (high) {
+        record.reg = 0xF;
+    } else if (chip8->index != index) {
+        record.reg = TRACE_REG_I;
+    }
+    if (record.reg < 16) record.value = chip8->V[record.reg];
+    if (record.reg == TRACE_REG_I) record.value = chip8->index;
+    trace_append(chip8->trace, &record);
+}
+#endif
+
+// === Interpreter ===
+// The body is written once against `quirks` and force-inlined into one
+// wrapper per profile with `quirks` a constant, so every quirk test below
+// folds away at compile time and each variant is a plain interpreter.
+//
+// Every memory access is masked with MEM_SIZE - 1, so PC and I wrap around
+// the 64 KB address space instead of being range-checked. Only the stack can
+// fault. Returns the fault this instruction raised, CHIP8_FAULT_NONE if any.
+static inline __attribute__((always_inline)) Chip8Fault chip8_execute(Chip8* chip8, const uint8_t quirks) {
+    // Input lands between instructions, at the slot it was stamped with
+    chip8_pollInput(chip8);
+    chip8->clock++;
+
+    // Blocked on FX0A: nothing is fetched until a key goes down
+    if (chip8->waitingForKey && !chip8_resolveKeyWait(chip8)) {
+        return CHIP8_FAULT_NONE;
+    }
+    // Blocked on DXYN until the next tick (COSMAC display wait)
+    if ((quirks & CHIP8_QUIRK_DISPLAY_WAIT) && chip8->waitingForVblank) {
+        return CHIP8_FAULT_NONE;
+    }
+    Chip8Fault status = CHIP8_FAULT_NONE;
+
+#ifdef CHIP8_PROFILE_OPCODES
+    Chip8OpFamily profiledFamily = OP_UNKNOWN;
+    uint64_t sampleStart = 0;
+    bool sampled = chip8->opcodeProfile.sampleInterval &&
+                   --chip8->opcodeProfile.sampleCountdown == 0;
+    if (sampled) {
+        chip8->opcodeProfile.sampleCountdown = chip8->opcodeProfile.sampleInterval;
+        sampleStart = SDL_GetPerformanceCounter();
     }
+#endif
 
     // Fetch
-    uint16_t opcode = chip8->memory[chip8->pc] << 8 | chip8->memory[chip8->pc + 1];
-    printf("PC: %04X  OPCODE: %04X\n", chip8->pc, opcode);
+    uint16_t opcode = chip8->memory[chip8->pc] << 8 | chip8->memory[(chip8->pc + 1) & (MEM_SIZE - 1)];
+    CHIP8_LOG("PC: %04X  OPCODE: %04X\n", chip8->pc, opcode);
+#ifdef CHIP8_TRACE
+    uint16_t tracePc = chip8->pc;
+    uint64_t traceV[2];  // registers before, to find the one the instruction changed
+    memcpy(traceV, chip8->V, sizeof(traceV));
+    uint16_t traceIndex = chip8->index;
+#endif
     chip8->pc += 2;  // Default PC advance
 
     // get the useful fields (nnn, kk, n, x, y)
@@ -222,315 +577,459 @@ void chip8Cycle(Chip8* chip8) {
     uint8_t x = (opcode & 0x0F00) >> 8;  // Second byte
     uint8_t y = (opcode & 0x00F0) >> 4;  // Third byte
 
-    // Decode
-    switch (opcode & 0xF000) {
+    // Decode: one table lookup gives the opcode family (same table as the disassembler)
+    Chip8OpFamily family = opcode_decode(opcode);
+    CHIP8_COUNT(family);
+
+    switch (family) {
         // ---------------- Stage 1: Basics ----------------
-        case 0x0000:
-            switch (opcode) {
-                case 0x00E0:  // CLS
-                    printf("CLS (clear screen)\n");
-                    memset(chip8->display,  // just clear the value in display
-                           0,
-                           DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(chip8->display[0]));
-                    break;
-                case 0x00EE:  // RET
-                    printf("RET (return from subroutine)\n");
-                    --chip8->sp;                          // pop from stack
-                    chip8->pc = chip8->stack[chip8->sp];  // give the address back to the pc
-                    break;
-                default:  // 0NNN (SYS addr)  (legacy, usually ignored)
-                    printf("SYS %03X (ignored)\n", nnn);
-                    break;
+        case OP_00E0:  // CLS
+            CHIP8_LOG("CLS (clear screen)\n");
+            chip8_clearDisplay(chip8, chip8->planes);
+            break;
+
+        case OP_00EE:  // RET
+            CHIP8_LOG("RET (return from subroutine)\n");
+            if (chip8->sp == 0) {
+                status = chip8_fault(chip8, CHIP8_FAULT_STACK_UNDERFLOW);
+                break;
             }
+            --chip8->sp;                          // pop from stack
+            chip8->pc = chip8->stack[chip8->sp];  // give the address back to the pc
+            break;
+
+        // ---------------- SUPER-CHIP: display modes & scrolling ----------------
+        case OP_00CN:  // SCD nibble
+            CHIP8_LOG("SCD %X\n", n);
+            chip8_scrollVertical(chip8, n);
+            break;
+
+        case OP_00DN:  // SCU nibble (XO-CHIP)
+            CHIP8_LOG("SCU %X\n", n);
+            chip8_scrollVertical(chip8, -n);
+            break;
+
+        case OP_00FB:  // SCR
+            CHIP8_LOG("SCR\n");
+            chip8_scrollHorizontal(chip8, true);
+            break;
+
+        case OP_00FC:  // SCL
+            CHIP8_LOG("SCL\n");
+            chip8_scrollHorizontal(chip8, false);
+            break;
+
+        case OP_00FD:  // EXIT: stay on this instruction from now on
+            CHIP8_LOG("EXIT\n");
+            chip8->pc -= 2;
+            break;
+
+        case OP_00FE:  // LOW
+        case OP_00FF:  // HIGH
+            CHIP8_LOG("%s\n", family == OP_00FF ? "HIGH" : "LOW");
+            chip8->hires = family == OP_00FF;
+            chip8_clearDisplay(chip8, ALL_PLANES);
             break;
 
-        case 0x1000:  // JP addr
-            printf("JP %03X\n", nnn);
+        case OP_0NNN:  // SYS addr  (legacy, usually ignored)
+            CHIP8_LOG("SYS %03X (ignored)\n", nnn);
+            break;
+
+        case OP_1NNN:  // JP addr
+            CHIP8_LOG("JP %03X\n", nnn);
             chip8->pc = nnn;  // go to the nnn directly
             break;
 
-        case 0x2000:  // CALL addr
-            printf("CALL %03X\n", nnn);
+        case OP_2NNN:  // CALL addr
+            CHIP8_LOG("CALL %03X\n", nnn);
+            if (chip8->sp >= STACK_SIZE) {
+                status = chip8_fault(chip8, CHIP8_FAULT_STACK_OVERFLOW);
+                break;
+            }
             chip8->stack[chip8->sp] =
                 chip8->pc;  // go to the nnn and save the returning address to the stack
             ++chip8->sp;    // to avoid overwrite on the line above
             chip8->pc = nnn;
             break;
 
-        case 0x6000:  // LD Vx, byte
-            printf("LD V%X, %02X\n", x, kk);
+        case OP_6XKK:  // LD Vx, byte
+            CHIP8_LOG("LD V%X, %02X\n", x, kk);
             chip8->V[x] = kk;  // write to the V register
             break;
 
-        case 0x7000:  // ADD Vx, byte
-            printf("ADD V%X, %02X\n", x, kk);
+        case OP_7XKK:  // ADD Vx, byte
+            CHIP8_LOG("ADD V%X, %02X\n", x, kk);
             chip8->V[x] += kk;  // add to the V register
             break;
 
         // // ---------------- Stage 2: Skips ----------------
-        case 0x3000:  // SE Vx, byte
-            printf("SE V%X, %02X\n", x, kk);
+        case OP_3XKK:  // SE Vx, byte
+            CHIP8_LOG("SE V%X, %02X\n", x, kk);
             if (chip8->V[x] == kk) {
-                chip8->pc += 2;
+                chip8->pc += chip8_skipLength(chip8, quirks);
             }
             break;
 
-        case 0x4000:  // SNE Vx, byte
-            printf("SNE V%X, %02X\n", x, kk);
+        case OP_4XKK:  // SNE Vx, byte
+            CHIP8_LOG("SNE V%X, %02X\n", x, kk);
             if (chip8->V[x] != kk) {
-                chip8->pc += 2;
+                chip8->pc += chip8_skipLength(chip8, quirks);
             }
             break;
 
-        case 0x5000:  // SE Vx, Vy
-            if (n == 0) {
-                printf("SE V%X, V%X\n", x, y);
-                if (chip8->V[x] == chip8->V[y]) {
-                    chip8->pc += 2;
-                }
-            } else {
-                printf("Unknown opcode: %04X\n", opcode);
+        case OP_5XY0:  // SE Vx, Vy
+            CHIP8_LOG("SE V%X, V%X\n", x, y);
+            if (chip8->V[x] == chip8->V[y]) {
+                chip8->pc += chip8_skipLength(chip8, quirks);
             }
-
             break;
 
-        case 0x9000:  // SNE Vx, Vy
-            if (n == 0) {
-                printf("SNE V%X, V%X\n", x, y);
-                if (chip8->V[x] != chip8->V[y]) {
-                    chip8->pc += 2;
-                }
-            } else
-                printf("Unknown opcode: %04X\n", opcode);
+        // ---------------- XO-CHIP: register ranges ----------------
+        case OP_5XY2: {  // SAVE Vx..Vy (either direction); I is unchanged
+            CHIP8_LOG("SAVE V%X..V%X\n", x, y);
+            unsigned count = (x <= y ? y - x : x - y) + 1u;
+            for (unsigned i = 0; i < count; i++) {
+                chip8->memory[(chip8->index + i) & (MEM_SIZE - 1)] = chip8->V[x <= y ? x + i : x - i];
+            }
+        } break;
+
+        case OP_5XY3: {  // LOAD Vx..Vy (either direction); I is unchanged
+            CHIP8_LOG("LOAD V%X..V%X\n", x, y);
+            unsigned count = (x <= y ? y - x : x - y) + 1u;
+            for (unsigned i = 0; i < count; i++) {
+                chip8->V[x <= y ? x + i : x - i] = chip8->memory[(chip8->index + i) & (MEM_SIZE - 1)];
+            }
+        } break;
+
+        case OP_9XY0:  // SNE Vx, Vy
+            CHIP8_LOG("SNE V%X, V%X\n", x, y);
+            if (chip8->V[x] != chip8->V[y]) {
+                chip8->pc += chip8_skipLength(chip8, quirks);
+            }
             break;
 
         // // ---------------- Stage 3: Arithmetic & Logic ----------------
-        case 0x8000:
-            switch (n) {
-                case 0x0:
-                    printf("LD V%X, V%X\n", x, y);
-                    chip8->V[x] = chip8->V[y];
-                    break;  // LD Vx, Vy
-                case 0x1:
-                    printf("OR V%X, V%X\n", x, y);
-                    chip8->V[x] |= chip8->V[y];
-                    break;  // OR Vx, Vy
-                case 0x2:
-                    printf("AND V%X, V%X\n", x, y);
-                    chip8->V[x] &= chip8->V[y];
-                    break;  // AND Vx, Vy
-                case 0x3:
-                    printf("XOR V%X, V%X\n", x, y);
-                    chip8->V[x] ^= chip8->V[y];
-                    break;  // XOR Vx, Vy
-                case 0x4:
-                    printf("ADD V%X, V%X (with carry)\n", x, y);
-                    uint16_t sum = chip8->V[x] + chip8->V[y];
-                    if (sum > 255U) {
-                        chip8->V[0xF] = 1;
-                    } else {
-                        chip8->V[0xF] = 0;
-                    }
-                    chip8->V[x] = sum & 0x00FF;
-                    break;  // ADD Vx, Vy (with carry)
-                case 0x5:
-                    printf("SUB V%X, V%X\n", x, y);
-                    if (chip8->V[x] > chip8->V[y]) {
-                        chip8->V[0xF] = 1;
-                    } else {
-                        chip8->V[0xF] = 0;
-                    }
-                    chip8->V[x] -= chip8->V[y];
-                    break;  // SUB Vx, Vy
-                case 0x6:
-                    printf("SHR V%X\n", x);
-                    chip8->V[0xF] = (chip8->V[x] & 0x1u);
-                    chip8->V[x] >>= 1;
-                    break;  //  (quirk) // SHR Vx
-                case 0x7:
-                    printf("SUBN V%X, V%X\n", x, y);
-                    if (chip8->V[y] > chip8->V[x]) {
-                        chip8->V[0xF] = 1;
-                    } else {
-                        chip8->V[0xF] = 0;
-                    }
-                    chip8->V[x] = chip8->V[y] - chip8->V[x];
-                    break;  // SUBN Vx, Vy
-                case 0xE:
-                    printf("SHL V%X\n", x);
-                    chip8->V[0xF] = (chip8->V[x] & 0x80u) >> 7u;
-                    chip8->V[x] <<= 1;
-                    break;  //  (quirk) // SHL Vx
-                default:
-                    printf("Unknown opcode: %04X\n", opcode);
-                    break;
-            }
+        case OP_8XY0:  // LD Vx, Vy
+            CHIP8_LOG("LD V%X, V%X\n", x, y);
+            chip8->V[x] = chip8->V[y];
+            break;
+
+        case OP_8XY1:  // OR Vx, Vy
+            CHIP8_LOG("OR V%X, V%X\n", x, y);
+            chip8->V[x] |= chip8->V[y];
+            if (quirks & CHIP8_QUIRK_VF_RESET) chip8->V[0xF] = 0;
+            break;
+
+        case OP_8XY2:  // AND Vx, Vy
+            CHIP8_LOG("AND V%X, V%X\n", x, y);
+            chip8->V[x] &= chip8->V[y];
+            if (quirks & CHIP8_QUIRK_VF_RESET) chip8->V[0xF] = 0;
+            break;
+
+        case OP_8XY3:  // XOR Vx, Vy
+            CHIP8_LOG("XOR V%X, V%X\n", x, y);
+            chip8->V[x] ^= chip8->V[y];
+            if (quirks & CHIP8_QUIRK_VF_RESET) chip8->V[0xF] = 0;
             break;
 
+        case OP_8XY4: {  // ADD Vx, Vy (with carry)
+            CHIP8_LOG("ADD V%X, V%X (with carry)\n", x, y);
+            uint16_t sum = chip8->V[x] + chip8->V[y];
+            chip8->V[x] = sum & 0x00FF;
+            chip8->V[0xF] = sum > 255U;  // flag last, so it wins when x is F
+        } break;
+
+        case OP_8XY5: {  // SUB Vx, Vy
+            CHIP8_LOG("SUB V%X, V%X\n", x, y);
+            uint8_t notBorrow = chip8->V[x] >= chip8->V[y];
+            chip8->V[x] -= chip8->V[y];
+            chip8->V[0xF] = notBorrow;
+        } break;
+
+        case OP_8XY6: {  // SHR Vx  (quirk: source is Vy on the COSMAC VIP)
+            CHIP8_LOG("SHR V%X\n", x);
+            uint8_t source = (quirks & CHIP8_QUIRK_SHIFT_VY) ? chip8->V[y] : chip8->V[x];
+            chip8->V[x] = source >> 1;
+            chip8->V[0xF] = (source & 0x1u);  // flag last, so it wins when x is F
+        } break;
+
+        case OP_8XY7: {  // SUBN Vx, Vy
+            CHIP8_LOG("SUBN V%X, V%X\n", x, y);
+            uint8_t notBorrow = chip8->V[y] >= chip8->V[x];
+            chip8->V[x] = chip8->V[y] - chip8->V[x];
+            chip8->V[0xF] = notBorrow;
+        } break;
+
+        case OP_8XYE: {  // SHL Vx  (quirk: source is Vy on the COSMAC VIP)
+            CHIP8_LOG("SHL V%X\n", x);
+            uint8_t source = (quirks & CHIP8_QUIRK_SHIFT_VY) ? chip8->V[y] : chip8->V[x];
+            chip8->V[x] = source << 1;
+            chip8->V[0xF] = (source & 0x80u) >> 7u;
+        } break;
+
         // // ---------------- Stage 4: Index/Jumps/Random ----------------
-        case 0xA000:  // LD I, addr
-            printf("LD I, %03X\n", nnn);
+        case OP_ANNN:  // LD I, addr
+            CHIP8_LOG("LD I, %03X\n", nnn);
             chip8->index = nnn;
             break;
 
-        case 0xB000:  // JP V0, addr
-            printf("JP V0, %03X\n", nnn);
-            chip8->pc = chip8->V[0] + nnn;
+        case OP_BNNN:  // JP V0, addr  (quirk: BXNN uses Vx on SUPER-CHIP)
+            CHIP8_LOG("JP V0, %03X\n", nnn);
+            chip8->pc = chip8->V[(quirks & CHIP8_QUIRK_JUMP_VX) ? x : 0] + nnn;
             break;
 
-        case 0xC000:  // RND Vx, byte
-            printf("RND V%X, %02X\n", x, kk);
-            uint8_t random_byte = rand() % 256;  // random 0-255
+        case OP_CXKK:  // RND Vx, byte
+            CHIP8_LOG("RND V%X, %02X\n", x, kk);
+            chip8->rng ^= chip8->rng << 13;  // xorshift32
+            chip8->rng ^= chip8->rng >> 17;
+            chip8->rng ^= chip8->rng << 5;
+            uint8_t random_byte = chip8->rng >> 24;  // random 0-255
             chip8->V[x] = random_byte & kk;
             break;
 
         // ---------------- Stage 5: Graphics ----------------
-        case 0xD000:  // DRW Vx, Vy, nibble
-            printf("DRW V%X, V%X, %X\n", x, y, n);
+        case OP_DXYN: {  // DRW Vx, Vy, nibble  (DXY0: 16x16 sprite, SUPER-CHIP)
+            // Each selected plane takes the next sprite's worth of bytes from I on
+            CHIP8_LOG("DRW V%X, V%X, %X\n", x, y, n);
 
-            uint8_t xPos = chip8->V[x] % DISPLAY_WIDTH;
-            uint8_t yPos = chip8->V[y] % DISPLAY_HEIGHT;
+            unsigned width = chip8_displayWidth(chip8);
+            unsigned height = chip8_displayHeight(chip8);
+            unsigned xPos = chip8->V[x] & (width - 1);
+            unsigned yPos = chip8->V[y] & (height - 1);
+            bool wide = (n == 0);
+            unsigned rows = wide ? 16 : n;
+            unsigned rowBytes = wide ? 2 : 1;
+            uint16_t sprite = chip8->index;
 
-            chip8->V[0xF] = 0;  // reset
+            bool clip = quirks & CHIP8_QUIRK_CLIP;  // else wrap around the edges
+            Chip8Blit blit = chip8_blitSetup(chip8, xPos, clip);
+            // Clipping drops the rows below the bottom edge; wrapping masks them back to the top
+            unsigned visible = (clip && yPos + rows > height) ? height - yPos : rows;
+            bool collision = false;
 
-            for (unsigned int row = 0; row < n; row++) {
-                uint8_t spriteByte = chip8->memory[chip8->index + row];
+            for (unsigned plane = 0; plane < DISPLAY_PLANES; plane++) {
+                if (!(chip8->planes & (1u << plane))) continue;
+                for (unsigned int row = 0; row < visible; row++) {
+                    unsigned at = sprite + row * rowBytes;
+                    uint16_t bits = chip8->memory[at & (MEM_SIZE - 1)] << 8;
+                    if (wide) bits |= chip8->memory[(at + 1) & (MEM_SIZE - 1)];
+                    collision |= chip8_blitRow(chip8, plane, &blit, (yPos + row) & (height - 1), bits);
+                }
+                sprite += rows * rowBytes;
+            }
+            chip8->V[0xF] = collision;
+            if (quirks & CHIP8_QUIRK_DISPLAY_WAIT) chip8->waitingForVblank = true;
+#if !defined(CHIP8_QUIET) && !defined(CHIP8_TRACE)
+            dumpDisplay(chip8);
+#endif
+        } break;
+
+        // // ---------------- Stage 6: Input ----------------
+        case OP_EX9E:  // SKP Vx
+            CHIP8_LOG("SKP V%X\n", x);
+            if ((chip8->keys >> (chip8->V[x] & 0xF)) & 1) chip8->pc += chip8_skipLength(chip8, quirks);
+            break;
 
-                for (unsigned int col = 0; col < 8; col++) {
-                    uint8_t spritePixel =
-                        spriteByte & (0x80u >> col);  // check each bit to see if 0 or 1
-                    uint32_t* screenPixel =
-                        &chip8->display[(yPos + row) * DISPLAY_WIDTH + (xPos + col)];
+        case OP_EXA1:  // SKNP Vx
+            CHIP8_LOG("SKNP V%X\n", x);
+            if (!((chip8->keys >> (chip8->V[x] & 0xF)) & 1)) chip8->pc += chip8_skipLength(chip8, quirks);
+            break;
+
+        // // ---------------- Stage 7: Timers & Memory ----------------
+        // ---------------- XO-CHIP: long I, planes, audio ----------------
+        case OP_F000:  // LD I, NNNN: the next word is the address
+            chip8->index = chip8->memory[chip8->pc] << 8 | chip8->memory[(chip8->pc + 1) & (MEM_SIZE - 1)];
+            CHIP8_LOG("LD I, %04X\n", chip8->index);
+            chip8->pc += 2;
+            break;
 
-                    if (spritePixel) {
-                        // Screen pixel also on - collision
-                        if (*screenPixel == 0xFFFFFFFF) {
-                            chip8->V[0xF] = 1;
-                        }
+        case OP_FN01:  // PLANE n
+            CHIP8_LOG("PLANE %X\n", x);
+            chip8->planes = x & ALL_PLANES;
+            break;
 
-                        // Effectively XOR with the sprite pixel
-                        *screenPixel ^= 0xFFFFFFFF;
-                    }
-                }
+        case OP_F002:  // AUDIO: 16-byte pattern at I
+            CHIP8_LOG("AUDIO\n");
+            for (uint8_t i = 0; i < AUDIO_PATTERN_SIZE; ++i) {
+                chip8->audioPattern[i] = chip8->memory[(chip8->index + i) & (MEM_SIZE - 1)];
             }
-            dumpDisplay(chip8);
+            chip8->hasAudioPattern = true;
             break;
 
-        // // ---------------- Stage 6: Input ----------------
-        case 0xE000:
-            uint8_t key = chip8->V[x];
-            switch (kk) {
-                case 0x9E:
-                    printf("SKP V%X\n", x);
-                    if (chip8->keypad[key]) chip8->pc += 2;
-                    break;  //
-
-                case 0xA1:
-                    printf("SKNP V%X\n", x);
-                    if (!chip8->keypad[key]) chip8->pc += 2;
-                    break;  //
-
-                default:
-                    printf("Unknown opcode: %04X\n", opcode);
-                    break;
+        case OP_FX3A:  // PITCH Vx
+            CHIP8_LOG("PITCH V%X\n", x);
+            chip8->pitch = chip8->V[x];
+            break;
+
+        case OP_FX07:
+            CHIP8_LOG("LD V%X, DT\n", x);
+            chip8->V[x] = chip8->delay_timer;
+            break;
+
+        case OP_FX0A:
+            CHIP8_LOG("LD V%X, K (wait key)\n", x);
+            // Park the CPU instead of rewinding the PC and re-executing FX0A;
+            // a key that is already held completes the wait right away
+            chip8->waitingForKey = true;
+            chip8->waitingRegister = x;
+            chip8_resolveKeyWait(chip8);
+            break;
+
+        case OP_FX15:
+            CHIP8_LOG("LD DT, V%X\n", x);
+            chip8->delay_timer = chip8->V[x];
+            break;
+
+        case OP_FX18:
+            CHIP8_LOG("LD ST, V%X\n", x);
+            chip8->sound_timer = chip8->V[x];
+            break;
+
+        case OP_FX1E:
+            CHIP8_LOG("ADD I, V%X\n", x);
+            chip8->index += chip8->V[x];
+            break;
+
+        case OP_FX29:
+            CHIP8_LOG("LD F, V%X (digit sprite)\n", x);
+            uint8_t digit = chip8->V[x];
+            chip8->index = FONTSET_START_ADDRESS + (5 * digit);
+            break;
+
+        case OP_FX30:
+            CHIP8_LOG("LD HF, V%X (big digit sprite)\n", x);
+            chip8->index = BIG_FONTSET_START_ADDRESS + (10 * (chip8->V[x] & 0xF));
+            break;
+
+        case OP_FX33:
+            CHIP8_LOG("LD B, V%X (BCD)\n", x);
+            uint8_t value = chip8->V[x];
+            chip8->memory[(chip8->index + 2) & (MEM_SIZE - 1)] = value % 10;  // Ones-place
+            value /= 10;
+            chip8->memory[(chip8->index + 1) & (MEM_SIZE - 1)] = value % 10;  // Tens-place
+            value /= 10;
+            chip8->memory[chip8->index] = value % 10;  // Hundreds-place
+            break;
+
+        case OP_FX55:
+            CHIP8_LOG("LD [I], V0..V%X\n", x);
+            for (uint8_t i = 0; i <= x; ++i) {
+                chip8->memory[(chip8->index + i) & (MEM_SIZE - 1)] = chip8->V[i];
             }
+            if (quirks & CHIP8_QUIRK_MEMORY_INCREMENT) chip8->index += x + 1;
             break;
 
-        // // ---------------- Stage 7: Timers & Memory ----------------
-        case 0xF000:
-            switch (kk) {
-                case 0x07:
-                    printf("LD V%X, DT\n", x);
-                    chip8->V[x] = chip8->delay_timer;
-                    break;  //
-                case 0x0A:
-                    printf("LD V%X, K (wait key)\n", x);
-                    if (chip8->keypad[0]) {
-                        chip8->V[x] = 0;
-                    } else if (chip8->keypad[1]) {
-                        chip8->V[x] = 1;
-                    } else if (chip8->keypad[2]) {
-                        chip8->V[x] = 2;
-                    } else if (chip8->keypad[3]) {
-                        chip8->V[x] = 3;
-                    } else if (chip8->keypad[4]) {
-                        chip8->V[x] = 4;
-                    } else if (chip8->keypad[5]) {
-                        chip8->V[x] = 5;
-                    } else if (chip8->keypad[6]) {
-                        chip8->V[x] = 6;
-                    } else if (chip8->keypad[7]) {
-                        chip8->V[x] = 7;
-                    } else if (chip8->keypad[8]) {
-                        chip8->V[x] = 8;
-                    } else if (chip8->keypad[9]) {
-                        chip8->V[x] = 9;
-                    } else if (chip8->keypad[10]) {
-                        chip8->V[x] = 10;
-                    } else if (chip8->keypad[11]) {
-                        chip8->V[x] = 11;
-                    } else if (chip8->keypad[12]) {
-                        chip8->V[x] = 12;
-                    } else if (chip8->keypad[13]) {
-                        chip8->V[x] = 13;
-                    } else if (chip8->keypad[14]) {
-                        chip8->V[x] = 14;
-                    } else if (chip8->keypad[15]) {
-                        chip8->V[x] = 15;
-                    } else {
-                        chip8->pc -= 2;
-                    }
-                    break;  //
-                case 0x15:
-                    printf("LD DT, V%X\n", x);
-                    chip8->delay_timer = chip8->V[x];
-                    break;  //
-                case 0x18:
-                    printf("LD ST, V%X\n", x);
-                    chip8->sound_timer = chip8->V[x];
-                    break;  //
-                case 0x1E:
-                    printf("ADD I, V%X\n", x);
-                    chip8->index += chip8->V[x];
-                    break;  //
-                case 0x29:
-                    printf("LD F, V%X (digit sprite)\n", x);
-                    uint8_t digit = chip8->V[x];
-                    chip8->index = FONTSET_START_ADDRESS + (5 * digit);
-                    break;  //
-                case 0x33:
-                    printf("LD B, V%X (BCD)\n", x);
-                    uint8_t value = chip8->V[x];
-                    chip8->memory[chip8->index + 2] = value % 10;  // Ones-place
-                    value /= 10;
-                    chip8->memory[chip8->index + 1] = value % 10;  // Tens-place
-                    value /= 10;
-                    chip8->memory[chip8->index] = value % 10;  // Hundreds-place
-                    break;
-                case 0x55:
-                    printf("LD [I], V0..V%X\n", x);
-                    for (uint8_t i = 0; i <= x; ++i) {
-                        chip8->memory[chip8->index + i] = chip8->V[i];
-                    }
-                    break;  //
-                case 0x65:
-                    printf("LD V0..V%X, [I]\n", x);
-                    for (uint8_t i = 0; i <= x; ++i) {
-                        chip8->V[i] = chip8->memory[chip8->index + i];
-                    }
-                    break;  //
-                default:
-                    printf("Unknown opcode: %04X\n", opcode);
-                    break;
+        case OP_FX65:
+            CHIP8_LOG("LD V0..V%X, [I]\n", x);
+            for (uint8_t i = 0; i <= x; ++i) {
+                chip8->V[i] = chip8->memory[(chip8->index + i) & (MEM_SIZE - 1)];
             }
+            if (quirks & CHIP8_QUIRK_MEMORY_INCREMENT) chip8->index += x + 1;
+            break;
+
+        case OP_FX75:
+            CHIP8_LOG("LD R, V0..V%X\n", x);
+            memcpy(chip8->rpl, chip8->V, x + 1);
+            break;
+
+        case OP_FX85:
+            CHIP8_LOG("LD V0..V%X, R\n", x);
+            memcpy(chip8->V, chip8->rpl, x + 1);
             break;
 
         default:
-            printf("Unknown opcode: %04X\n", opcode);
+            CHIP8_LOG("Unknown opcode: %04X\n", opcode);
             break;
     }
 
+#ifdef CHIP8_PROFILE_OPCODES
+    if (sampled) {
+        chip8->opcodeProfile.sampled[profiledFamily]++;
+        chip8->opcodeProfile.ticks[profiledFamily] += SDL_GetPerformanceCounter() - sampleStart;
+    }
+#endif
+
+#ifdef CHIP8_TRACE
+    if (chip8->trace) chip8_trace(chip8, tracePc, opcode, traceV, traceIndex, status);
+#endif
+
     // divide op code as 4 nibbles (4 bits)
     // [op][x][y][n]
     // Execute
-}
\ No newline at end of file
+    return status;
+}
+
+#define CHIP8_CYCLE_VARIANT(profile, quirks, hz, description) \
+    Chip8Fault chip8Cycle_##profile(Chip8* chip8) { return chip8_execute(chip8, quirks); }
+CHIP8_PROFILES(CHIP8_CYCLE_VARIANT)
+
+// Execute one instruction with the loaded ROM's quirks. Anything but
+// CHIP8_FAULT_NONE means it faulted (see chip8->fault / faultPc).
+Chip8Fault chip8Cycle(Chip8* chip8) {
+    return chip8->cycle(chip8);
+}
+
+// Run the next `cycles` instruction slots. While the CPU is parked on FX0A
+// the clock jumps straight to the next queued key event (or the end) instead
+// of spinning; a display wait, which only the next timer tick ends, uses up
+// the rest. Stops early on a fault.
+// Returns the number of instructions actually executed.
+int chip8_runCycles(Chip8* chip8, int cycles) {
+    Chip8Fault (*cycle)(Chip8*) = chip8->cycle;
+    uint64_t end = chip8->clock + cycles;
+    int executed = 0;
+    while (chip8->clock < end) {
+        chip8_pollInput(chip8);
+        if (chip8->waitingForVblank) {
+            chip8->clock = end;
+            break;
+        }
+        if (chip8->waitingForKey && !chip8_resolveKeyWait(chip8)) {
+            chip8->clock = chip8->input.next < end ? chip8->input.next : end;
+            continue;
+        }
+        if (cycle(chip8) != CHIP8_FAULT_NONE) break;
+        executed++;
+    }
+    return executed;
+}
+
+// One 60 Hz frame of emulated time: chip8->hz / TIMER_HZ instruction slots (the
+// remainder carries over in *slotAccumulator), then a timer tick.
+// Returns the number of instructions executed.
+int chip8_runFrame(Chip8* chip8, int* slotAccumulator) {
+    *slotAccumulator += chip8->hz;
+    int slots = *slotAccumulator / TIMER_HZ;
+    *slotAccumulator %= TIMER_HZ;
+
+    int executed = chip8_runCycles(chip8, slots);
+    chip8_tickTimers(chip8);
+    return executed;
+}
+
+// === Save states ===
+// Everything a run depends on is inside Chip8: no heap and no pointers into
+// itself (`cycle` points at code, the same in every copy). A state is the
+// struct itself, and saving or loading one is a single ~70 KB memcpy, a few
+// microseconds.
+typedef Chip8 Chip8State;
+
+void chip8_saveState(const Chip8* chip8, Chip8State* state) {
+    memcpy(state, chip8, sizeof(*state));
+}
+
+void chip8_loadState(Chip8* chip8, const Chip8State* state) {
+    memcpy(chip8, state, sizeof(*chip8));
+}
+
+// Run-ahead: `ahead` becomes where `chip8` will be `frames` frames from now if
+// the keys stay as they are. The frontend presents `ahead` and keeps running
+// `chip8`, which is never touched, so there is nothing to restore.
+void chip8_runAhead(const Chip8* chip8, Chip8State* ahead, int frames) {
+    chip8_saveState(chip8, ahead);
+#ifdef CHIP8_TRACE
+    ahead->trace = NULL;  // frames that are thrown away are not part of the run
+#endif
+    int slotAccumulator = 0;
+    for (int i = 0; i < frames; i++) chip8_runFrame(ahead, &slotAccumulator);
+}
@@ -0,0 +1,348 @@
+#pragma once
+#include <chip8.h>
+#include <header.h>
+#include <opcodes.h>
+
+#define DEBUG_READ 0x1
+#define DEBUG_WRITE 0x2
+
+typedef enum {
+    DEBUG_STOP_NONE,
+    DEBUG_STOP_BREAKPOINT,
+    DEBUG_STOP_MEMORY,
+    DEBUG_STOP_INDEX,
+    DEBUG_STOP_REGISTER,
+    DEBUG_STOP_FAULT,
+} DebugStop;
+
+// === Debugger ===
+// Breakpoints and watchpoints are bitmaps (one bit per address), so a check is
+// a couple of loads no matter how many are set. Watchpoints are evaluated
+// before the instruction runs, by decoding what the pending opcode will touch.
+// chip8Cycle itself knows nothing about the debugger: the frontend only calls
+// debugger_check while `armed` is set, so with nothing set the run loop is
+// the same as without a debugger.
+typedef struct {
+    uint8_t breakpoints[MEM_SIZE / 8];
+    uint8_t watchRead[MEM_SIZE / 8];
+    uint8_t watchWrite[MEM_SIZE / 8];
+    uint16_t watchVRead;   // one bit per V register
+    uint16_t watchVWrite;
+    uint8_t watchIndex;    // DEBUG_READ | DEBUG_WRITE
+    int breakpointCount;
+    int memoryWatchCount;  // bits set in watchRead and watchWrite together
+    bool armed;            // anything set at all
+    bool paused;
+    bool resuming;         // don't stop again at resumePc right after continuing
+    uint16_t resumePc;
+
+    // Why we last stopped
+    DebugStop stop;
+    uint16_t stopAddress;  // PC, memory address, register number or faulting PC
+    uint8_t stopAccess;
+} Debugger;
+
+// What the instruction at PC is about to read and write
+typedef struct {
+    uint16_t vRead, vWrite;
+    uint8_t index;
+    uint8_t memAccess;
+    uint16_t memStart;
+    uint8_t memLength;
+} DebugAccess;
+
+static inline bool debugger_bit(const uint8_t* bitmap, uint16_t address) {
+    address &= MEM_SIZE - 1;
+    return bitmap[address >> 3] & (1u << (address & 7));
+}
+
+// Returns true if the bit changed
+static inline bool debugger_setBit(uint8_t* bitmap, uint16_t address, bool on) {
+    address &= MEM_SIZE - 1;
+    uint8_t old = bitmap[address >> 3];
+    if (on) {
+        bitmap[address >> 3] |= 1u << (address & 7);
+    } else {
+        bitmap[address >> 3] &= ~(1u << (address & 7));
+    }
+    return bitmap[address >> 3] != old;
+}
+
+static void debugger_updateArmed(Debugger* d) {
+    d->armed = d->breakpointCount || d->memoryWatchCount || d->watchIndex || d->watchVRead ||
+               d->watchVWrite;
+}
+
+void debugger_init(Debugger* d) {
+    memset(d, 0, sizeof(*d));
+}
+
+// Returns true if a breakpoint is now set at `address`
+bool debugger_toggleBreakpoint(Debugger* d, uint16_t address) {
+    bool on = !debugger_bit(d->breakpoints, address);
+    debugger_setBit(d->breakpoints, address, on);
+    d->breakpointCount += on ? 1 : -1;
+    debugger_updateArmed(d);
+    return on;
+}
+
+void debugger_watchMemory(Debugger* d, uint16_t address, uint16_t length, uint8_t access) {
+    // Only bits that actually flip count, so overlapping watches add nothing
+    for (uint16_t i = 0; i < length; i++) {
+        if (access & DEBUG_READ) d->memoryWatchCount += debugger_setBit(d->watchRead, address + i, true);
+        if (access & DEBUG_WRITE) d->memoryWatchCount += debugger_setBit(d->watchWrite, address + i, true);
+    }
+    debugger_updateArmed(d);
+}
+
+void debugger_unwatchMemory(Debugger* d, uint16_t address, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        d->memoryWatchCount -= debugger_setBit(d->watchRead, address + i, false);
+        d->memoryWatchCount -= debugger_setBit(d->watchWrite, address + i, false);
+    }
+    debugger_updateArmed(d);
+}
+
+void debugger_watchIndex(Debugger* d, uint8_t access) {
+    d->watchIndex |= access;
+    debugger_updateArmed(d);
+}
+
+void debugger_watchRegister(Debugger* d, uint8_t reg, uint8_t access) {
+    if (access & DEBUG_READ) d->watchVRead |= 1u << (reg & 0xF);
+    if (access & DEBUG_WRITE) d->watchVWrite |= 1u << (reg & 0xF);
+    debugger_updateArmed(d);
+}
+
+// Mirrors the semantics in chip8Cycle; only the operands matter here
+static DebugAccess debugger_access(const Chip8* chip8, uint16_t opcode) {
+    uint8_t x = (opcode & 0x0F00) >> 8;
+    uint8_t y = (opcode & 0x00F0) >> 4;
+    uint16_t vx = 1u << x, vy = 1u << y, vf = 1u << 0xF;
+    uint16_t v0ToX = (uint16_t)((2u << x) - 1);
+    uint16_t xToY = (uint16_t)(x <= y ? (2u << y) - (1u << x) : (2u << x) - (1u << y));  // 5XY2/5XY3 range
+    DebugAccess a = {0};
+
+    switch (opcode_decode(opcode)) {
+        case OP_3XKK:
+        case OP_4XKK:
+        case OP_EX9E:
+        case OP_EXA1:
+        case OP_FX15:
+        case OP_FX18:
+            a.vRead = vx;
+            break;
+        case OP_5XY0:
+        case OP_9XY0:
+            a.vRead = vx | vy;
+            break;
+        case OP_6XKK:
+        case OP_CXKK:
+        case OP_FX07:
+        case OP_FX0A:
+            a.vWrite = vx;
+            break;
+        case OP_7XKK:
+            a.vRead = a.vWrite = vx;
+            break;
+        case OP_8XY0:
+            a.vRead = vy;
+            a.vWrite = vx;
+            break;
+        case OP_8XY1:
+        case OP_8XY2:
+        case OP_8XY3:
+            a.vRead = vx | vy;
+            a.vWrite = vx | ((chip8->quirks & CHIP8_QUIRK_VF_RESET) ? vf : 0);
+            break;
+        case OP_8XY4:
+        case OP_8XY5:
+        case OP_8XY7:
+            a.vRead = vx | vy;
+            a.vWrite = vx | vf;
+            break;
+        case OP_8XY6:
+        case OP_8XYE:
+            a.vRead = (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) ? vy : vx;
+            a.vWrite = vx | vf;
+            break;
+        case OP_ANNN:
+            a.index = DEBUG_WRITE;
+            break;
+        case OP_BNNN:
+            a.vRead = (chip8->quirks & CHIP8_QUIRK_JUMP_VX) ? vx : 1u << 0;
+            break;
+        case OP_DXYN: {
+            a.vRead = vx | vy;
+            a.vWrite = vf;
+            a.index = DEBUG_READ;
+            a.memAccess = DEBUG_READ;
+            a.memStart = chip8->index;
+            uint8_t planes = (chip8->planes & 1) + (chip8->planes >> 1 & 1);  // one sprite per plane
+            a.memLength = ((opcode & 0x000F) ? (opcode & 0x000F) : 32) * planes;  // DXY0: 16 rows of 2 bytes
+        } break;
+        case OP_5XY2:
+            a.vRead = xToY;
+            a.index = DEBUG_READ;
+            a.memAccess = DEBUG_WRITE;
+            a.memStart = chip8->index;
+            a.memLength = (uint8_t)(x <= y ? y - x + 1 : x - y + 1);
+            break;
+        case OP_5XY3:
+            a.vWrite = xToY;
+            a.index = DEBUG_READ;
+            a.memAccess = DEBUG_READ;
+            a.memStart = chip8->index;
+            a.memLength = (uint8_t)(x <= y ? y - x + 1 : x - y + 1);
+            break;
+        case OP_F000:
+            a.index = DEBUG_WRITE;
+            break;
+        case OP_F002:
+            a.index = DEBUG_READ;
+            a.memAccess = DEBUG_READ;
+            a.memStart = chip8->index;
+            a.memLength = AUDIO_PATTERN_SIZE;
+            break;
+        case OP_FX3A:
+            a.vRead = vx;
+            break;
+        case OP_FX1E:
+            a.vRead = vx;
+            a.index = DEBUG_READ | DEBUG_WRITE;
+            break;
+        case OP_FX29:
+        case OP_FX30:
+            a.vRead = vx;
+            a.index = DEBUG_WRITE;
+            break;
+        case OP_FX75:
+            a.vRead = v0ToX;
+            break;
+        case OP_FX85:
+            a.vWrite = v0ToX;
+            break;
+        case OP_FX33:
+            a.vRead = vx;
+            a.index = DEBUG_READ;
+            a.memAccess = DEBUG_WRITE;
+            a.memStart = chip8->index;
+            a.memLength = 3;
+            break;
+        case OP_FX55:
+            a.vRead = v0ToX;
+            a.index = DEBUG_READ | ((chip8->quirks & CHIP8_QUIRK_MEMORY_INCREMENT) ? DEBUG_WRITE : 0);
+            a.memAccess = DEBUG_WRITE;
+            a.memStart = chip8->index;
+            a.memLength = x + 1;
+            break;
+        case OP_FX65:
+            a.vWrite = v0ToX;
+            a.index = DEBUG_READ | ((chip8->quirks & CHIP8_QUIRK_MEMORY_INCREMENT) ? DEBUG_WRITE : 0);
+            a.memAccess = DEBUG_READ;
+            a.memStart = chip8->index;
+            a.memLength = x + 1;
+            break;
+        default:
+            break;
+    }
+    return a;
+}
+
+static bool debugger_stopAt(Debugger* d, DebugStop stop, uint16_t address, uint8_t access) {
+    d->stop = stop;
+    d->stopAddress = address;
+    d->stopAccess = access;
+    d->paused = true;
+    return true;
+}
+
+// Call before chip8Cycle, only when d->armed. Returns true (and pauses) if
+// the instruction at PC hits a breakpoint or a watchpoint.
+bool debugger_check(Debugger* d, const Chip8* chip8) {
+    uint16_t pc = chip8->pc;
+    if (d->resuming) {
+        d->resuming = false;
+        if (pc == d->resumePc) return false;
+    }
+    d->resumePc = pc;  // where a stop below would leave us
+
+    if (debugger_bit(d->breakpoints, pc)) return debugger_stopAt(d, DEBUG_STOP_BREAKPOINT, pc, 0);
+
+    uint16_t opcode = chip8->memory[pc & (MEM_SIZE - 1)] << 8 | chip8->memory[(pc + 1) & (MEM_SIZE - 1)];
+    DebugAccess a = debugger_access(chip8, opcode);
+
+    uint16_t vRead = a.vRead & d->watchVRead;
+    uint16_t vWrite = a.vWrite & d->watchVWrite;
+    if (vRead | vWrite) {
+        uint16_t hit = vRead | vWrite;
+        uint8_t reg = 0;
+        while (!(hit & (1u << reg))) reg++;
+        uint8_t access = ((vRead >> reg) & 1 ? DEBUG_READ : 0) | ((vWrite >> reg) & 1 ? DEBUG_WRITE : 0);
+        return debugger_stopAt(d, DEBUG_STOP_REGISTER, reg, access);
+    }
+    if (a.index & d->watchIndex) return debugger_stopAt(d, DEBUG_STOP_INDEX, 0, a.index & d->watchIndex);
+
+    if (d->memoryWatchCount && a.memAccess) {
+        const uint8_t* bitmap = (a.memAccess == DEBUG_READ) ? d->watchRead : d->watchWrite;
+        for (uint8_t i = 0; i < a.memLength; i++) {
+            if (debugger_bit(bitmap, a.memStart + i)) {
+                return debugger_stopAt(d, DEBUG_STOP_MEMORY, (a.memStart + i) & (MEM_SIZE - 1), a.memAccess);
+            }
+        }
+    }
+    return false;
+}
+
+// Call when chip8Cycle returns a fault: pauses on the faulting instruction
+void debugger_fault(Debugger* d, const Chip8* chip8) {
+    debugger_stopAt(d, DEBUG_STOP_FAULT, chip8->faultPc, 0);
+}
+
+// Leave the pause; if a check stopped us here, that instruction now runs
+// without stopping again
+void debugger_continue(Debugger* d, const Chip8* chip8) {
+    d->paused = false;
+    d->resuming = d->stop != DEBUG_STOP_NONE && chip8->pc == d->resumePc;
+    d->stop = DEBUG_STOP_NONE;
+}
+
+static const char* debugger_accessName(uint8_t access) {
+    if (access == (DEBUG_READ | DEBUG_WRITE)) return "read/write";
+    return access == DEBUG_WRITE ? "write" : "read";
+}
+
+// Console report: why we stopped, the pending instruction and the registers
+void debugger_print(const Debugger* d, const Chip8* chip8, FILE* out) {
+    switch (d->stop) {
+        case DEBUG_STOP_BREAKPOINT:
+            fprintf(out, "breakpoint at %03X\n", d->stopAddress);
+            break;
+        case DEBUG_STOP_MEMORY:
+            fprintf(out, "watchpoint: %s of memory[%03X]\n", debugger_accessName(d->stopAccess), d->stopAddress);
+            break;
+        case DEBUG_STOP_INDEX:
+            fprintf(out, "watchpoint: %s of I\n", debugger_accessName(d->stopAccess));
+            break;
+        case DEBUG_STOP_REGISTER:
+            fprintf(out, "watchpoint: %s of V%X\n", debugger_accessName(d->stopAccess), d->stopAddress);
+            break;
+        case DEBUG_STOP_FAULT:
+            fprintf(out, "fault at %03X: %s\n", d->stopAddress, chip8FaultNames[chip8->fault]);
+            break;
+        default:
+            break;
+    }
+
+    uint16_t pc = chip8->pc & (MEM_SIZE - 1);
+    uint16_t opcode = chip8->memory[pc] << 8 | chip8->memory[(pc + 1) & (MEM_SIZE - 1)];
+    char text[32];
+    opcode_format(opcode, text, sizeof(text));
+    fprintf(out, "%03X    %04X   %s\n", pc, opcode, text);
+
+    for (int i = 0; i < 16; i++) {
+        fprintf(out, "V%X=%02X%s", i, chip8->V[i], (i % 8 == 7) ? "\n" : " ");
+    }
+    fprintf(out, "I=%03X  SP=%X  DT=%02X  ST=%02X\n", chip8->index, chip8->sp, chip8->delay_timer,
+            chip8->sound_timer);
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include <chip8.h>
+#include <header.h>
+#include <opcodes.h>
+
+#define DISASM_START 0x200
+
+// Per-address flags
+#define DISASM_CODE 0x01      // an instruction starts here
+#define DISASM_LEADER 0x02    // first instruction of a basic block
+#define DISASM_CALLED 0x04    // 2NNN target: subroutine entry
+#define DISASM_DATA 0x08      // ANNN / F000 NNNN target: sprite/table data
+#define DISASM_COVERED 0x10   // byte belongs to an instruction
+#define DISASM_INDIRECT 0x20  // BNNN: successors unknown
+#define DISASM_QUEUED 0x40    // already on the worklist
+
+// === Static disassembler ===
+// Recursive traversal from 0x200 over a memory image. Control flow comes from
+// the flow column of the opcode table and decoding from the same 64K table
+// chip8Cycle uses, so the two cannot disagree on what an opcode is. Bytes no
+// path reaches are data; ANNN targets are labelled as sprites (or as font /
+// interpreter area when below 0x200).
+typedef struct {
+    const uint8_t* memory;  // MEM_SIZE bytes, ROM at DISASM_START
+    uint32_t end;           // one past the last ROM byte (up to MEM_SIZE)
+    uint8_t flags[MEM_SIZE];
+    uint16_t worklist[MEM_SIZE];
+    int pending;
+    uint32_t instructions;  // distinct instructions found
+    uint32_t blocks;
+    uint32_t fontRefs;  // ANNN below 0x200
+} Disasm;
+
+static inline uint16_t disasm_opcode(const Disasm* d, uint16_t address) {
+    return d->memory[address] << 8 | d->memory[(address + 1) & (MEM_SIZE - 1)];
+}
+
+static inline bool disasm_inRom(const Disasm* d, uint16_t address) {
+    return address >= DISASM_START && address + 1u < d->end;
+}
+
+// Bytes taken by the instruction at `address`: 4 for F000 NNNN, else 2
+static inline uint16_t disasm_width(const Disasm* d, uint16_t address) {
+    return opcodeInfo[opcode_decode(disasm_opcode(d, address))].flow == FLOW_LONG ? 4 : 2;
+}
+
+static void disasm_dataRef(Disasm* d, uint16_t target) {
+    if (target < DISASM_START) {
+        d->fontRefs++;
+    } else {
+        d->flags[target] |= DISASM_DATA;
+    }
+}
+
+static void disasm_push(Disasm* d, uint16_t target, uint8_t flags) {
+    if (!disasm_inRom(d, target)) return;  // outside the image: nothing to follow
+    if (!(d->flags[target] & (DISASM_CODE | DISASM_QUEUED))) d->worklist[d->pending++] = target;
+    d->flags[target] |= flags | DISASM_LEADER | DISASM_QUEUED;
+}
+
+// Every address is queued at most once and walked at most once, so the pass
+// is linear in the ROM size.
+void disasm_analyze(Disasm* d, const uint8_t* memory, uint32_t end) {
+    opcodes_init();
+    d->memory = memory;
+    d->end = end > MEM_SIZE ? MEM_SIZE : end;
+    // Only the image's own flags are ever read, so that is all that needs
+    // clearing: a few KB, not the whole 64 KB address space
+    if (d->end > DISASM_START) memset(&d->flags[DISASM_START], 0, d->end - DISASM_START);
+    d->pending = 0;
+    d->instructions = d->blocks = d->fontRefs = 0;
+
+    disasm_push(d, DISASM_START, 0);
+    while (d->pending) {
+        uint16_t pc = d->worklist[--d->pending];
+
+        // Straight-line walk until control leaves or joins known code
+        while (disasm_inRom(d, pc) && !(d->flags[pc] & DISASM_CODE)) {
+            uint16_t opcode = disasm_opcode(d, pc);
+            uint16_t nnn = opcode & 0x0FFF;
+            Chip8OpFlow flow = opcodeInfo[opcode_decode(opcode)].flow;
+
+            d->flags[pc] |= DISASM_CODE | DISASM_COVERED;
+            d->flags[pc + 1] |= DISASM_COVERED;
+            d->instructions++;
+
+            if (flow == FLOW_NEXT) {
+                pc += 2;
+            } else if (flow == FLOW_DATA) {
+                disasm_dataRef(d, nnn);
+                pc += 2;
+            } else if (flow == FLOW_LONG) {
+                if (!disasm_inRom(d, pc + 2)) break;  // operand cut off by the end of the ROM
+                d->flags[pc + 2] |= DISASM_COVERED;
+                d->flags[pc + 3] |= DISASM_COVERED;
+                disasm_dataRef(d, disasm_opcode(d, pc + 2));
+                pc += 4;
+            } else if (flow == FLOW_SKIP) {
+                // A skip steps over a whole F000 NNNN; only XO-CHIP ROMs contain one
+                uint16_t next = pc + 2;
+                disasm_push(d, next + (disasm_inRom(d, next) ? disasm_width(d, next) : 2), 0);
+                disasm_push(d, next, 0);
+                break;
+            } else if (flow == FLOW_CALL) {
+                disasm_push(d, nnn, DISASM_CALLED);
+                disasm_push(d, pc + 2, 0);  // the return lands here
+                break;
+            } else if (flow == FLOW_JUMP) {
+                disasm_push(d, nnn, 0);
+                break;
+            } else {  // RET, BNNN, unknown: no static successor
+                if (flow == FLOW_INDIRECT) d->flags[pc] |= DISASM_INDIRECT;
+                break;
+            }
+        }
+        // Fell into code reached earlier: that address now starts a block
+        if (disasm_inRom(d, pc) && (d->flags[pc] & DISASM_CODE)) d->flags[pc] |= DISASM_LEADER;
+    }
+
+    for (uint32_t address = DISASM_START; address < d->end; address++) {
+        if ((d->flags[address] & (DISASM_CODE | DISASM_LEADER)) == (DISASM_CODE | DISASM_LEADER)) {
+            d->blocks++;
+        }
+    }
+}
+
+// Last instruction of the block starting at `leader`
+static uint16_t disasm_blockEnd(const Disasm* d, uint16_t leader) {
+    uint16_t pc = leader;
+    for (;;) {
+        Chip8OpFlow flow = opcodeInfo[opcode_decode(disasm_opcode(d, pc))].flow;
+        if (flow != FLOW_NEXT && flow != FLOW_DATA && flow != FLOW_LONG) return pc;
+        uint16_t next = pc + (flow == FLOW_LONG ? 4 : 2);
+        if (!disasm_inRom(d, next) || (d->flags[next] & (DISASM_CODE | DISASM_LEADER)) != DISASM_CODE) {
+            return pc;
+        }
+        pc = next;
+    }
+}
+
+static void disasm_label(const Disasm* d, uint16_t address, char* out, size_t size) {
+    if (address == DISASM_START) {
+        snprintf(out, size, "main");
+    } else if (d->flags[address] & DISASM_CALLED) {
+        snprintf(out, size, "sub_%03X", address);
+    } else if (d->flags[address] & DISASM_CODE) {
+        snprintf(out, size, "L_%03X", address);
+    } else {
+        snprintf(out, size, "spr_%03X", address);
+    }
+}
+
+// Assembly-style listing: labelled blocks, data as db rows, sprites drawn
+void disasm_writeListing(const Disasm* d, FILE* out) {
+    char label[16];
+    bool sprite = false;  // inside data reached through ANNN
+    uint32_t address = DISASM_START;
+    while (address < d->end) {
+        uint8_t flags = d->flags[address];
+
+        if (flags & DISASM_CODE) {
+            if (flags & (DISASM_LEADER | DISASM_DATA)) {
+                disasm_label(d, address, label, sizeof(label));
+                fprintf(out, "\n%s:%s\n", label, (flags & DISASM_DATA) ? "  ; also read as data" : "");
+            }
+            uint16_t opcode = disasm_opcode(d, address);
+            char text[32];
+            opcode_format(opcode, text, sizeof(text));
+            const char* note = NULL;
+            char operand[16];
+            Chip8OpFlow flow = opcodeInfo[opcode_decode(opcode)].flow;
+            if (flow == FLOW_DATA && (opcode & 0x0FFF) < DISASM_START) {
+                note = "font/interpreter area";
+            } else if (flow == FLOW_LONG && address + 3u < d->end) {
+                snprintf(operand, sizeof(operand), "I = %04X", disasm_opcode(d, address + 2));
+                note = operand;
+            } else if (flags & DISASM_INDIRECT) {
+                note = "computed jump";
+            }
+            if (note) {
+                fprintf(out, "%03X    %04X   %-22s ; %s\n", address, opcode, text, note);
+            } else {
+                fprintf(out, "%03X    %04X   %s\n", address, opcode, text);
+            }
+            address += (flow == FLOW_LONG && address + 3u < d->end) ? 4 : 2;
+            sprite = false;
+            continue;
+        }
+
+        // Data run: up to the next instruction, a new ANNN target or 8 bytes
+        if (flags & DISASM_DATA) {
+            disasm_label(d, address, label, sizeof(label));
+            fprintf(out, "\n%s:\n", label);
+            sprite = true;
+        }
+
+        fprintf(out, "%03X    db    ", address);
+        uint32_t row = 0;
+        do {
+            uint8_t byte = d->memory[address];
+            if (sprite) {
+                char bits[9];
+                for (int bit = 0; bit < 8; bit++) bits[bit] = (byte & (0x80u >> bit)) ? '#' : '.';
+                bits[8] = '\0';
+                fprintf(out, "%02X  ; %s", byte, bits);
+            } else {
+                fprintf(out, "%s%02X", row ? ", " : "", byte);
+            }
+            address++;
+            row++;
+        } while (!sprite && row < 8 && address < d->end &&
+                 !(d->flags[address] & (DISASM_CODE | DISASM_DATA)));
+        fputc('\n', out);
+    }
+}
+
+static void disasm_edge(const Disasm* d, uint16_t from, uint16_t to, const char* style, FILE* out) {
+    if (!disasm_inRom(d, to) || !(d->flags[to] & DISASM_CODE)) return;
+    fprintf(out, "  b_%03X -> b_%03X%s;\n", from, to, style);
+}
+
+// Control-flow graph in DOT: one node per basic block, solid edges for
+// fall-through and jumps, labelled edges for skips, dashed edges for calls
+void disasm_writeDot(const Disasm* d, const char* name, FILE* out) {
+    fprintf(out, "digraph \"%s\" {\n", name);
+    fprintf(out, "  node [shape=box, fontname=monospace];\n");
+
+    for (uint32_t leader = DISASM_START; leader < d->end; leader++) {
+        if ((d->flags[leader] & (DISASM_CODE | DISASM_LEADER)) != (DISASM_CODE | DISASM_LEADER)) continue;
+        uint16_t last = disasm_blockEnd(d, leader);
+
+        char label[16];
+        disasm_label(d, leader, label, sizeof(label));
+        fprintf(out, "  b_%03X [label=\"%s:\\l", leader, label);
+        for (uint32_t pc = leader; pc <= last; pc += disasm_width(d, pc)) {
+            char text[32];
+            opcode_format(disasm_opcode(d, pc), text, sizeof(text));
+            fprintf(out, "%03X  %s\\l", pc, text);
+        }
+        fprintf(out, "\"%s];\n", (d->flags[leader] & DISASM_CALLED) ? ", style=bold" : "");
+
+        uint16_t opcode = disasm_opcode(d, last);
+        uint16_t nnn = opcode & 0x0FFF;
+        switch (opcodeInfo[opcode_decode(opcode)].flow) {
+            case FLOW_JUMP:
+                disasm_edge(d, leader, nnn, "", out);
+                break;
+            case FLOW_CALL:
+                disasm_edge(d, leader, nnn, " [style=dashed, label=\"call\"]", out);
+                disasm_edge(d, leader, last + 2, "", out);
+                break;
+            case FLOW_SKIP:
+                disasm_edge(d, leader, last + 2, " [label=\"no skip\"]", out);
+                disasm_edge(d, leader, last + 2 + disasm_width(d, last + 2), " [label=\"skip\"]", out);
+                break;
+            case FLOW_NEXT:
+            case FLOW_DATA:
+                disasm_edge(d, leader, last + 2, "", out);
+                break;
+            case FLOW_LONG:
+                disasm_edge(d, leader, last + 4, "", out);
+                break;
+            default:  // RET, computed jump, unknown: no static successor
+                break;
+        }
+    }
+    fprintf(out, "}\n");
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include <chip8.h>
+#include <header.h>
+
+#define FRAMESHARE_NAME "Local\\chip8-frames"  // default segment, per login session
+#define FRAMESHARE_SLOTS 16                    // publishers per segment, one VM each
+#define FRAMESHARE_MAGIC 0x53463843u           // "C8FS"
+#define FRAMESHARE_VERSION 2
+#define FRAMESHARE_SPIN_LIMIT 100000  // pauses on an odd sequence before a slot counts as stuck
+#define FRAMESHARE_UNUSED (-1)        // frameshare_read: nothing published to the slot yet
+#define FRAMESHARE_STUCK (-2)         // ... left mid-write, its publisher is gone
+
+// === Shared frame export ===
+// A named shared-memory segment of FRAMESHARE_SLOTS frame slots. Each VM
+// publishes its packed display (Chip8.display as is: one bit per pixel, two
+// planes) into its own slot once a frame; recorders and observers in other
+// processes map the segment read-only and copy frames out.
+//
+// Every slot is a sequence lock. The publisher makes `sequence` odd, writes
+// the frame, then makes it even again; a reader copies the slot and keeps the
+// copy only if it saw the same even sequence before and after. Neither side
+// takes a lock or makes a syscall, and a slow reader never stalls a VM. A
+// publisher that dies mid-write leaves its slot odd: readers give up on it
+// after FRAMESHARE_SPIN_LIMIT pauses.
+//
+// A publisher claims its slot by writing its `owner` token with one compare
+// and swap, and frameshare_close gives it back. Opening a slot whose owner is
+// still running fails; a dead owner's slot is taken over, and only then is
+// its sequence moved on to a fresh even value.
+typedef struct {
+    _Alignas(64) volatile uint32_t sequence;  // odd while the publisher is writing
+    volatile uint64_t owner;                   // publisher's frameshare_processToken, 0 = free
+    uint32_t frame;                            // frames published, 0 = slot unused
+    uint16_t width, height;                    // current resolution, 64x32 or 128x64
+    uint8_t planes;                            // plane mask FN01 selected (XO-CHIP)
+    uint64_t display[DISPLAY_PLANES][HIRES_HEIGHT][DISPLAY_WORDS];
+} FrameSlot;
+
+typedef struct {
+    uint32_t magic, version;
+    uint32_t slotCount, slotSize;  // so a reader can check its layout matches
+    FrameSlot slots[FRAMESHARE_SLOTS];
+} FrameShareSegment;
+
+typedef struct {
+    HANDLE mapping;
+    FrameShareSegment* segment;
+    FrameSlot* slot;  // the one this process publishes to, NULL for readers
+    uint64_t owner;   // our token in slot->owner
+} FrameShare;
+
+// Process id in the low half, the low bits of its start time in the high
+// half, so a recycled id is not mistaken for the publisher that had it
+static uint64_t frameshare_processToken(HANDLE process, DWORD pid) {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(process, &created, &exited, &kernel, &user)) return 0;
+    return (uint64_t)created.dwLowDateTime << 32 | pid;
+}
+
+static bool frameshare_ownerAlive(uint64_t owner) {
+    DWORD pid = (uint32_t)owner;
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!process) return GetLastError() == ERROR_ACCESS_DENIED;  // running, just not ours to inspect
+    DWORD exitCode = 0;
+    bool alive = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE &&
+                 frameshare_processToken(process, pid) == owner;
+    CloseHandle(process);
+    return alive;
+}
+
+static bool frameshare_map(FrameShare* s, const char* name, DWORD access) {
+    s->segment = s->mapping ? MapViewOfFile(s->mapping, access, 0, 0, sizeof(FrameShareSegment)) : NULL;
+    if (!s->segment) {
+        fprintf(stderr, "frameshare: cannot map %s\n", name);
+        if (s->mapping) CloseHandle(s->mapping);
+        s->mapping = NULL;
+        return false;
+    }
+    return true;
+}
+
+void frameshare_close(FrameShare* s) {
+    if (s->slot) InterlockedCompareExchange64((volatile LONG64*)&s->slot->owner, 0, (LONG64)s->owner);  // release the claim
+    if (s->segment) UnmapViewOfFile(s->segment);
+    if (s->mapping) CloseHandle(s->mapping);
+    s->segment = NULL;
+    s->mapping = NULL;
+    s->slot = NULL;
+}
+
+// Publisher: create the segment, or join it if another VM already did
+bool frameshare_open(FrameShare* s, const char* name, int slot) {
+    s->slot = NULL;
+    if (slot < 0 || slot >= FRAMESHARE_SLOTS) {
+        fprintf(stderr, "frameshare: slot %d out of range 0-%d\n", slot, FRAMESHARE_SLOTS - 1);
+        return false;
+    }
+    s->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(FrameShareSegment), name);
+    bool created = s->mapping && GetLastError() != ERROR_ALREADY_EXISTS;
+    if (!frameshare_map(s, name, FILE_MAP_ALL_ACCESS)) return false;
+
+    FrameShareSegment* segment = s->segment;
+    if (created) {  // new pages are zero, so every slot starts unused at sequence 0
+        segment->version = FRAMESHARE_VERSION;
+        segment->slotCount = FRAMESHARE_SLOTS;
+        segment->slotSize = sizeof(FrameSlot);
+        SDL_MemoryBarrierRelease();
+        segment->magic = FRAMESHARE_MAGIC;
+    } else if (segment->magic && (segment->version != FRAMESHARE_VERSION || segment->slotSize != sizeof(FrameSlot))) {
+        fprintf(stderr, "frameshare: %s has a different layout\n", name);
+        frameshare_close(s);
+        return false;
+    }
+
+    FrameSlot* claimed = &segment->slots[slot];
+    uint64_t owner = claimed->owner;
+    s->owner = frameshare_processToken(GetCurrentProcess(), GetCurrentProcessId());
+    if ((owner && frameshare_ownerAlive(owner)) ||
+        (uint64_t)InterlockedCompareExchange64((volatile LONG64*)&claimed->owner, (LONG64)s->owner, (LONG64)owner) !=
+            owner) {
+        fprintf(stderr, "frameshare: slot %d of %s is in use by process %lu\n", slot, name,
+                (unsigned long)(uint32_t)claimed->owner);
+        frameshare_close(s);
+        return false;
+    }
+    s->slot = claimed;
+    if (owner) {
+        // The previous publisher died without closing. Clear an odd sequence
+        // it left behind; rounding up, not down, so no reader can mistake the
+        // half-written frame for one it has seen complete
+        s->slot->sequence = (s->slot->sequence + 1) & ~1u;
+    }
+    return true;
+}
+
+// Reader: map an existing segment read-only
+bool frameshare_attach(FrameShare* s, const char* name) {
+    s->slot = NULL;
+    s->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (!frameshare_map(s, name, FILE_MAP_READ)) return false;
+    if (s->segment->magic != FRAMESHARE_MAGIC || s->segment->version != FRAMESHARE_VERSION ||
+        s->segment->slotSize != sizeof(FrameSlot)) {
+        fprintf(stderr, "frameshare: %s is not a version %d frame segment\n", name, FRAMESHARE_VERSION);
+        frameshare_close(s);
+        return false;
+    }
+    return true;
+}
+
+// Copy the current display into this process's slot
+void frameshare_publish(FrameShare* s, const Chip8* chip8) {
+    FrameSlot* slot = s->slot;
+    uint32_t sequence = slot->sequence;
+    slot->sequence = sequence + 1;
+    SDL_MemoryBarrierRelease();  // odd sequence visible before any of the frame
+
+    slot->frame++;
+    slot->width = (uint16_t)chip8_displayWidth(chip8);
+    slot->height = (uint16_t)chip8_displayHeight(chip8);
+    slot->planes = chip8->planes;
+    memcpy(slot->display, chip8->display, sizeof(slot->display));
+
+    SDL_MemoryBarrierRelease();  // the whole frame visible before the even sequence
+    slot->sequence = sequence + 2;
+}
+
+// Consistent copy of slot `index` into `out`. Returns the number of torn
+// copies thrown away on the way (0 almost always), FRAMESHARE_UNUSED if the
+// slot has never been published to, or FRAMESHARE_STUCK if it stayed
+// mid-write for FRAMESHARE_SPIN_LIMIT pauses.
+int frameshare_read(const FrameShare* s, int index, FrameSlot* out) {
+    const FrameSlot* slot = &s->segment->slots[index];
+    for (int retries = 0;; retries++) {
+        uint32_t before;
+        for (int spins = 0; (before = slot->sequence) & 1; spins++) {  // mid-write
+            if (spins == FRAMESHARE_SPIN_LIMIT) return FRAMESHARE_STUCK;
+            SDL_CPUPauseInstruction();
+        }
+        SDL_MemoryBarrierAcquire();
+        memcpy(out, (const void*)slot, sizeof(*out));
+        SDL_MemoryBarrierAcquire();  // the copy completes before the sequence is read again
+        if (slot->sequence == before) return out->frame ? retries : FRAMESHARE_UNUSED;
+    }
+}
+
+// Colour 0..3 of pixel x, y in a copied slot, as chip8_pixel
+static inline uint8_t frameshare_pixel(const FrameSlot* slot, int x, int y) {
+    unsigned bit = 63 - (x & 63);
+    return ((slot->display[0][y][x >> 6] >> bit) & 1) | (((slot->display[1][y][x >> 6] >> bit) & 1) << 1);
+}
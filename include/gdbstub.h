@@ -0,0 +1,455 @@
+#pragma once
+#include <chip8.h>
+#include <debugger.h>
+#include <header.h>
+
+#define GDB_BUFFER_SIZE 0x4000  // packet buffers; an 'm' reply is capped to fit (8 KB of memory)
+#define GDB_REGISTER_COUNT 21    // V0..VF, I, PC, SP, DT, ST
+
+// === GDB remote stub ===
+// GDB remote serial protocol over TCP on 127.0.0.1, for `target remote :PORT`.
+// Register layout (also served as target.xml): V0..VF (8 bit), I (16), PC (16),
+// SP (8), DT (8), ST (8), little-endian. Breakpoints and watchpoints go into
+// the Debugger bitmaps, so they cost the same as the frontend's own.
+//
+// Everything is non-blocking and driven by gdbstub_poll. The frontend polls
+// once per 60 Hz frame while running (to accept a client or catch Ctrl-C)
+// and continuously while paused, never per instruction.
+typedef struct {
+    SOCKET listener;
+    SOCKET client;
+    bool running;  // GDB sent c/s and waits for a stop reply
+    char in[GDB_BUFFER_SIZE];
+    int inLength;
+    char out[GDB_BUFFER_SIZE + 8];
+} GdbStub;
+
+static const char gdbHex[] = "0123456789abcdef";
+
+bool gdbstub_open(GdbStub* g, uint16_t port) {
+    WSADATA wsa;
+    g->listener = g->client = INVALID_SOCKET;
+    g->running = false;
+    g->inLength = 0;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+
+    g->listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (g->listener == INVALID_SOCKET) {
+        fprintf(stderr, "gdb stub: cannot create a socket\n");
+        WSACleanup();
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(g->listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    u_long nonBlocking = 1;
+    if (bind(g->listener, (struct sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR ||
+        listen(g->listener, 1) == SOCKET_ERROR ||
+        ioctlsocket(g->listener, FIONBIO, &nonBlocking) == SOCKET_ERROR) {
+        fprintf(stderr, "gdb stub: cannot listen on port %u\n", port);
+        closesocket(g->listener);
+        g->listener = INVALID_SOCKET;
+        WSACleanup();
+        return false;
+    }
+    printf("gdb stub listening on 127.0.0.1:%u\n", port);
+    return true;
+}
+
+static void gdbstub_dropClient(GdbStub* g, Debugger* d, const Chip8* chip8) {
+    closesocket(g->client);
+    g->client = INVALID_SOCKET;
+    g->running = false;
+    g->inLength = 0;
+    if (d->paused) debugger_continue(d, chip8);  // the guest keeps running without GDB
+    printf("gdb detached\n");
+}
+
+static void gdbstub_sendRaw(GdbStub* g, const char* data, int length) {
+    while (length > 0) {
+        int sent = send(g->client, data, length, 0);
+        if (sent == SOCKET_ERROR) {
+            if (WSAGetLastError() != WSAEWOULDBLOCK) return;  // recv will notice the hang-up
+            SDL_Delay(1);
+            continue;
+        }
+        data += sent;
+        length -= sent;
+    }
+}
+
+// Frame `payload` as $payload#checksum
+static void gdbstub_send(GdbStub* g, const char* payload) {
+    int length = 0;
+    uint8_t checksum = 0;
+    g->out[length++] = '$';
+    for (const char* c = payload; *c && length < GDB_BUFFER_SIZE; c++) {
+        g->out[length++] = *c;
+        checksum += (uint8_t)*c;
+    }
+    g->out[length++] = '#';
+    g->out[length++] = gdbHex[checksum >> 4];
+    g->out[length++] = gdbHex[checksum & 0xF];
+    gdbstub_sendRaw(g, g->out, length);
+}
+
+static int gdbstub_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static uint32_t gdbstub_parseHex(const char** p) {
+    uint32_t value = 0;
+    int digit;
+    while ((digit = gdbstub_nibble(**p)) >= 0) {
+        value = value << 4 | digit;
+        (*p)++;
+    }
+    return value;
+}
+
+static char* gdbstub_putByte(char* out, uint8_t byte) {
+    *out++ = gdbHex[byte >> 4];
+    *out++ = gdbHex[byte & 0xF];
+    return out;
+}
+
+// Register n as little-endian hex; returns the byte width
+static int gdbstub_readRegister(const Chip8* chip8, int n, char* out) {
+    uint16_t value;
+    int width = 1;
+    if (n < 16) {
+        value = chip8->V[n];
+    } else if (n == 16) {
+        value = chip8->index;
+        width = 2;
+    } else if (n == 17) {
+        value = chip8->pc;
+        width = 2;
+    } else if (n == 18) {
+        value = chip8->sp;
+    } else if (n == 19) {
+        value = chip8->delay_timer;
+    } else {
+        value = chip8->sound_timer;
+    }
+    out = gdbstub_putByte(out, value & 0xFF);
+    if (width == 2) out = gdbstub_putByte(out, value >> 8);
+    *out = '\0';
+    return width;
+}
+
+// Hex digits register n takes in g/G/p/P packets
+static inline size_t gdbstub_registerDigits(int n) {
+    return (n == 16 || n == 17) ? 4 : 2;
+}
+
+// Parses a little-endian hex register value (gdbstub_registerDigits(n) digits,
+// which the caller has checked are there); returns the hex digits consumed
+static int gdbstub_writeRegister(Chip8* chip8, int n, const char* hex) {
+    uint16_t value = gdbstub_nibble(hex[0]) << 4 | gdbstub_nibble(hex[1]);
+    if (n == 16 || n == 17) value |= (gdbstub_nibble(hex[2]) << 4 | gdbstub_nibble(hex[3])) << 8;
+
+    if (n < 16) {
+        chip8->V[n] = (uint8_t)value;
+    } else if (n == 16) {
+        chip8->index = value & (MEM_SIZE - 1);
+    } else if (n == 17) {
+        chip8->pc = value & (MEM_SIZE - 1);
+    } else if (n == 18) {
+        chip8->sp = value & 0xF;
+    } else if (n == 19) {
+        chip8->delay_timer = (uint8_t)value;
+    } else {
+        chip8->sound_timer = (uint8_t)value;
+    }
+    return (int)gdbstub_registerDigits(n);
+}
+
+static int gdbstub_targetXml(char* out, size_t size) {
+    int length = snprintf(out, size,
+                          "<?xml version=\"1.0\"?><!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+                          "<target><feature name=\"org.chip8.cpu\">");
+    for (int i = 0; i < 16; i++) {
+        length += snprintf(out + length, size - length, "<reg name=\"v%x\" bitsize=\"8\" type=\"uint8\"/>", i);
+    }
+    length += snprintf(out + length, size - length,
+                       "<reg name=\"i\" bitsize=\"16\" type=\"data_ptr\"/>"
+                       "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+                       "<reg name=\"sp\" bitsize=\"8\" type=\"uint8\"/>"
+                       "<reg name=\"dt\" bitsize=\"8\" type=\"uint8\"/>"
+                       "<reg name=\"st\" bitsize=\"8\" type=\"uint8\"/>"
+                       "</feature></target>");
+    return length;
+}
+
+// qXfer:features:read:target.xml:offset,length
+static void gdbstub_sendTargetXml(GdbStub* g, const char* args) {
+    static char xml[2048];
+    int xmlLength = gdbstub_targetXml(xml, sizeof(xml));
+    uint32_t offset = gdbstub_parseHex(&args);
+    args++;
+    uint32_t length = gdbstub_parseHex(&args);
+
+    static char reply[2048 + 2];
+    if (offset >= (uint32_t)xmlLength) {
+        gdbstub_send(g, "l");
+        return;
+    }
+    uint32_t chunk = xmlLength - offset < length ? xmlLength - offset : length;
+    reply[0] = (offset + chunk < (uint32_t)xmlLength) ? 'm' : 'l';
+    memcpy(reply + 1, xml + offset, chunk);
+    reply[1 + chunk] = '\0';
+    gdbstub_send(g, reply);
+}
+
+static void gdbstub_sendStop(GdbStub* g, const Debugger* d) {
+    char reply[32];
+    if (d->stop == DEBUG_STOP_MEMORY) {
+        bool read = debugger_bit(d->watchRead, d->stopAddress);
+        bool write = debugger_bit(d->watchWrite, d->stopAddress);
+        const char* kind = (read && write) ? "awatch" : (write ? "watch" : "rwatch");
+        snprintf(reply, sizeof(reply), "T05%s:%x;", kind, d->stopAddress);
+    } else if (d->stop == DEBUG_STOP_NONE) {
+        snprintf(reply, sizeof(reply), "S02");  // interrupted (Ctrl-C / F5)
+    } else if (d->stop == DEBUG_STOP_FAULT) {
+        snprintf(reply, sizeof(reply), "S0B");  // SIGSEGV: the ROM faulted
+    } else {
+        snprintf(reply, sizeof(reply), "S05");
+    }
+    gdbstub_send(g, reply);
+}
+
+// Z/z: type,addr,kind. 0/1 breakpoint, 2 write, 3 read, 4 access watchpoint
+static void gdbstub_breakpoint(GdbStub* g, Debugger* d, const char* args, bool insert) {
+    uint32_t type = gdbstub_parseHex(&args);
+    args++;
+    uint16_t address = gdbstub_parseHex(&args) & (MEM_SIZE - 1);
+    args++;
+    uint16_t length = gdbstub_parseHex(&args);
+
+    if (type <= 1) {
+        if (debugger_bit(d->breakpoints, address) != insert) debugger_toggleBreakpoint(d, address);
+    } else if (type <= 4) {
+        static const uint8_t access[] = {0, 0, DEBUG_WRITE, DEBUG_READ, DEBUG_READ | DEBUG_WRITE};
+        if (insert) {
+            debugger_watchMemory(d, address, length ? length : 1, access[type]);
+        } else {
+            debugger_unwatchMemory(d, address, length ? length : 1);
+        }
+    } else {
+        gdbstub_send(g, "");
+        return;
+    }
+    gdbstub_send(g, "OK");
+}
+
+static void gdbstub_handle(GdbStub* g, Chip8* chip8, Debugger* d, char* packet) {
+    static char reply[GDB_BUFFER_SIZE];
+    const char* args = packet + 1;
+
+    switch (packet[0]) {
+        case '?':
+            gdbstub_send(g, "S05");
+            break;
+
+        case 'g': {
+            char* out = reply;
+            for (int n = 0; n < GDB_REGISTER_COUNT; n++) {
+                out += 2 * gdbstub_readRegister(chip8, n, out);
+            }
+            gdbstub_send(g, reply);
+        } break;
+
+        case 'G':
+            for (int n = 0; n < GDB_REGISTER_COUNT && strlen(args) >= gdbstub_registerDigits(n); n++) {
+                args += gdbstub_writeRegister(chip8, n, args);
+            }
+            gdbstub_send(g, "OK");
+            break;
+
+        case 'p': {
+            uint32_t n = gdbstub_parseHex(&args);
+            if (n >= GDB_REGISTER_COUNT) {
+                gdbstub_send(g, "E01");
+                break;
+            }
+            gdbstub_readRegister(chip8, n, reply);
+            gdbstub_send(g, reply);
+        } break;
+
+        case 'P': {
+            uint32_t n = gdbstub_parseHex(&args);
+            if (n >= GDB_REGISTER_COUNT || *args != '=' || strlen(args + 1) < gdbstub_registerDigits(n)) {
+                gdbstub_send(g, "E01");
+                break;
+            }
+            gdbstub_writeRegister(chip8, n, args + 1);
+            gdbstub_send(g, "OK");
+        } break;
+
+        case 'm': {
+            uint32_t address = gdbstub_parseHex(&args);
+            args++;
+            uint32_t length = gdbstub_parseHex(&args);
+            if (address >= MEM_SIZE) {
+                gdbstub_send(g, "E01");
+                break;
+            }
+            if (length > MEM_SIZE - address) length = MEM_SIZE - address;
+            if (length > (GDB_BUFFER_SIZE - 1) / 2) length = (GDB_BUFFER_SIZE - 1) / 2;  // GDB asks again for the rest
+            char* out = reply;
+            for (uint32_t i = 0; i < length; i++) out = gdbstub_putByte(out, chip8->memory[address + i]);
+            *out = '\0';
+            gdbstub_send(g, reply);
+        } break;
+
+        case 'M': {
+            uint32_t address = gdbstub_parseHex(&args);
+            args++;
+            uint32_t length = gdbstub_parseHex(&args);
+            if (*args++ != ':' || address >= MEM_SIZE || length > MEM_SIZE - address || strlen(args) < 2 * length) {
+                gdbstub_send(g, "E01");
+                break;
+            }
+            for (uint32_t i = 0; i < length; i++, args += 2) {
+                chip8->memory[address + i] = gdbstub_nibble(args[0]) << 4 | gdbstub_nibble(args[1]);
+            }
+            gdbstub_send(g, "OK");
+        } break;
+
+        case 'Z':
+        case 'z':
+            gdbstub_breakpoint(g, d, args, packet[0] == 'Z');
+            break;
+
+        case 's':
+            if (*args) chip8->pc = gdbstub_parseHex(&args) & (MEM_SIZE - 1);
+            if (chip8Cycle(chip8) != CHIP8_FAULT_NONE) {
+                debugger_fault(d, chip8);
+                gdbstub_sendStop(g, d);
+                break;
+            }
+            d->stop = DEBUG_STOP_NONE;
+            gdbstub_send(g, "S05");
+            break;
+
+        case 'c':
+            if (*args) chip8->pc = gdbstub_parseHex(&args) & (MEM_SIZE - 1);
+            debugger_continue(d, chip8);
+            g->running = true;  // the stop reply goes out from gdbstub_poll
+            break;
+
+        case 'D':
+            gdbstub_send(g, "OK");
+            gdbstub_dropClient(g, d, chip8);
+            break;
+
+        case 'k':
+            gdbstub_dropClient(g, d, chip8);
+            break;
+
+        case 'H':
+            gdbstub_send(g, "OK");
+            break;
+
+        case 'q':
+            if (strncmp(packet, "qSupported", 10) == 0) {
+                snprintf(reply, sizeof(reply), "PacketSize=%x;qXfer:features:read+", GDB_BUFFER_SIZE);
+                gdbstub_send(g, reply);
+            } else if (strncmp(packet, "qXfer:features:read:target.xml:", 31) == 0) {
+                gdbstub_sendTargetXml(g, packet + 31);
+            } else if (strcmp(packet, "qAttached") == 0) {
+                gdbstub_send(g, "1");
+            } else if (strcmp(packet, "qC") == 0) {
+                gdbstub_send(g, "QC1");
+            } else if (strcmp(packet, "qfThreadInfo") == 0) {
+                gdbstub_send(g, "m1");
+            } else if (strcmp(packet, "qsThreadInfo") == 0) {
+                gdbstub_send(g, "l");
+            } else {
+                gdbstub_send(g, "");
+            }
+            break;
+
+        default:  // unsupported: empty reply (vCont, X, ...)
+            gdbstub_send(g, "");
+            break;
+    }
+}
+
+// Accept a client, read what arrived, answer complete packets, and send the
+// stop reply once a continue has ended in a pause.
+void gdbstub_poll(GdbStub* g, Chip8* chip8, Debugger* d) {
+    if (g->listener == INVALID_SOCKET) return;
+
+    if (g->client == INVALID_SOCKET) {
+        g->client = accept(g->listener, NULL, NULL);
+        if (g->client == INVALID_SOCKET) return;
+
+        u_long nonBlocking = 1;
+        int noDelay = 1;
+        ioctlsocket(g->client, FIONBIO, &nonBlocking);
+        setsockopt(g->client, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+        printf("gdb attached\n");
+        d->paused = true;  // GDB expects a halted target
+        d->stop = DEBUG_STOP_NONE;
+        g->running = false;
+    }
+
+    int received = recv(g->client, g->in + g->inLength, GDB_BUFFER_SIZE - 1 - g->inLength, 0);
+    if (received == 0 || (received == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK)) {
+        gdbstub_dropClient(g, d, chip8);
+        return;
+    }
+    if (received > 0) g->inLength += received;
+
+    int start = 0;
+    while (start < g->inLength) {
+        char c = g->in[start];
+        if (c == '+' || c == '-') {  // acks: we never retransmit over TCP
+            start++;
+        } else if (c == 0x03) {  // Ctrl-C
+            start++;
+            d->paused = true;
+            d->stop = DEBUG_STOP_NONE;
+        } else if (c == '$') {
+            char* end = memchr(g->in + start, '#', g->inLength - start);
+            if (!end || end + 2 >= g->in + g->inLength) break;  // incomplete: wait for more
+            *end = '\0';
+            gdbstub_sendRaw(g, "+", 1);
+            gdbstub_handle(g, chip8, d, g->in + start + 1);
+            if (g->client == INVALID_SOCKET) return;
+            start = (int)(end + 3 - g->in);
+        } else {
+            start++;  // line noise
+        }
+    }
+    memmove(g->in, g->in + start, g->inLength - start);
+    g->inLength -= start;
+    if (g->inLength == GDB_BUFFER_SIZE - 1) g->inLength = 0;  // oversized packet: drop it
+
+    if (g->running && d->paused) {
+        g->running = false;
+        gdbstub_sendStop(g, d);
+    }
+}
+
+bool gdbstub_attached(const GdbStub* g) {
+    return g->client != INVALID_SOCKET;
+}
+
+// Only after a successful gdbstub_open, which it balances
+void gdbstub_close(GdbStub* g) {
+    if (g->client != INVALID_SOCKET) closesocket(g->client);
+    if (g->listener != INVALID_SOCKET) closesocket(g->listener);
+    g->client = g->listener = INVALID_SOCKET;
+    WSACleanup();
+}
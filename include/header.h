@@ -5,4 +5,5 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <winsock2.h>  // before windows.h, which otherwise pulls in the old winsock.h
 #include <windows.h>
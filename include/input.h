@@ -0,0 +1,58 @@
+#pragma once
+#include <header.h>
+
+#define INPUT_QUEUE_SIZE 64  // power of two; far more than one host poll produces
+#define INPUT_NONE UINT64_MAX
+
+// === Input queue ===
+// Key changes stamped with the emulated clock (instruction slots since
+// chip8_init) at which they take effect. The interpreter applies them at the
+// first instruction boundary at or after that time, so the same event list
+// gives the same run however the host loop happens to be scheduled.
+typedef struct {
+    uint64_t clock;
+    uint8_t key;  // 0-F
+    bool down;
+} InputEvent;
+
+typedef struct {
+    InputEvent events[INPUT_QUEUE_SIZE];
+    uint32_t head, tail;  // free-running; index with & (INPUT_QUEUE_SIZE - 1)
+    uint64_t next;        // clock of the oldest event, INPUT_NONE when empty
+} InputQueue;
+
+void input_init(InputQueue* q) {
+    q->head = q->tail = 0;
+    q->next = INPUT_NONE;
+}
+
+// Events are kept in push order: one stamped before the previous event is
+// moved up to it. Returns false (event dropped) if the queue is full.
+bool input_push(InputQueue* q, uint64_t clock, uint8_t key, bool down) {
+    if (q->tail - q->head == INPUT_QUEUE_SIZE) return false;
+    if (q->tail != q->head) {
+        uint64_t last = q->events[(q->tail - 1) & (INPUT_QUEUE_SIZE - 1)].clock;
+        if (clock < last) clock = last;
+    }
+    q->events[q->tail++ & (INPUT_QUEUE_SIZE - 1)] = (InputEvent){clock, (uint8_t)(key & 0xF), down};
+    if (q->next == INPUT_NONE) q->next = clock;
+    return true;
+}
+
+// Fold every event due by `clock` into the key mask (bit k = key k down)
+void input_apply(InputQueue* q, uint64_t clock, uint16_t* keys) {
+    while (q->head != q->tail) {
+        const InputEvent* e = &q->events[q->head & (INPUT_QUEUE_SIZE - 1)];
+        if (e->clock > clock) {
+            q->next = e->clock;
+            return;
+        }
+        if (e->down) {
+            *keys |= 1u << e->key;
+        } else {
+            *keys &= ~(1u << e->key);
+        }
+        q->head++;
+    }
+    q->next = INPUT_NONE;
+}
@@ -0,0 +1,320 @@
+#pragma once
+#include <chip8.h>
+#include <header.h>
+#include <stddef.h>  // offsetof
+
+#define NETPLAY_MAX_ROLLBACK 8     // frames we may run ahead of the last confirmed remote input
+#define NETPLAY_STATES 16          // power of two, > NETPLAY_MAX_ROLLBACK
+#define NETPLAY_HISTORY 128        // power of two; input frames kept per player
+#define NETPLAY_PACKET_INPUTS 64   // unacknowledged inputs resent per packet, oldest first
+#define NETPLAY_DELAY_SLOTS 256    // packets the simulated link can hold in flight
+#define NETPLAY_MAGIC 0x504E3843u  // "C8NP"
+
+// === Transport ===
+// Connected UDP socket pair on 127.0.0.1 with a simulated link in front of
+// it: outgoing packets are dropped with probability `lossPercent` or held in
+// a delay line until `delayNs` of caller time has passed. Time is whatever
+// the caller passes as `now`, so a test can run at any speed.
+typedef struct {
+    uint64_t sendAt;
+    int length;
+    uint8_t data[sizeof(uint32_t) * 4 + NETPLAY_PACKET_INPUTS * sizeof(uint16_t)];
+} NetDelayed;
+
+typedef struct {
+    SOCKET socket;
+    uint64_t delayNs;
+    uint32_t lossPercent;
+    uint32_t rng;  // xorshift32 for the loss decision, seeded per peer
+    NetDelayed delayed[NETPLAY_DELAY_SLOTS];
+    uint32_t delayedHead, delayedTail;
+    uint32_t sent, lost;
+} NetTransport;
+
+bool nettransport_open(NetTransport* t, uint16_t localPort, uint16_t remotePort) {
+    WSADATA wsa;
+    t->socket = INVALID_SOCKET;
+    t->delayedHead = t->delayedTail = 0;
+    t->sent = t->lost = 0;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+
+    t->socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (t->socket == INVALID_SOCKET) {
+        fprintf(stderr, "netplay: cannot create a socket\n");
+        WSACleanup();
+        return false;
+    }
+
+    struct sockaddr_in local = {0}, remote = {0};
+    local.sin_family = remote.sin_family = AF_INET;
+    local.sin_addr.s_addr = remote.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    local.sin_port = htons(localPort);
+    remote.sin_port = htons(remotePort);
+    u_long nonBlocking = 1;
+    if (bind(t->socket, (struct sockaddr*)&local, sizeof(local)) == SOCKET_ERROR ||
+        connect(t->socket, (struct sockaddr*)&remote, sizeof(remote)) == SOCKET_ERROR ||
+        ioctlsocket(t->socket, FIONBIO, &nonBlocking) == SOCKET_ERROR) {
+        fprintf(stderr, "netplay: cannot use UDP port %u\n", localPort);
+        closesocket(t->socket);
+        t->socket = INVALID_SOCKET;
+        WSACleanup();
+        return false;
+    }
+    return true;
+}
+
+// Balances a successful nettransport_open; a no-op after a failed one
+void nettransport_close(NetTransport* t) {
+    if (t->socket == INVALID_SOCKET) return;
+    closesocket(t->socket);
+    t->socket = INVALID_SOCKET;
+    WSACleanup();
+}
+
+// Hand the packets whose delay is over to the socket
+void nettransport_pump(NetTransport* t, uint64_t now) {
+    while (t->delayedHead != t->delayedTail) {
+        NetDelayed* d = &t->delayed[t->delayedHead & (NETPLAY_DELAY_SLOTS - 1)];
+        if (d->sendAt > now) break;
+        send(t->socket, (const char*)d->data, d->length, 0);  // a full socket buffer is just more loss
+        t->delayedHead++;
+    }
+}
+
+void nettransport_send(NetTransport* t, uint64_t now, const void* data, int length) {
+    t->sent++;
+    t->rng ^= t->rng << 13;  // xorshift32
+    t->rng ^= t->rng >> 17;
+    t->rng ^= t->rng << 5;
+    if (t->rng % 100 < t->lossPercent || t->delayedTail - t->delayedHead == NETPLAY_DELAY_SLOTS ||
+        length > (int)sizeof(t->delayed[0].data)) {
+        t->lost++;
+        return;
+    }
+    NetDelayed* d = &t->delayed[t->delayedTail++ & (NETPLAY_DELAY_SLOTS - 1)];
+    d->sendAt = now + t->delayNs;
+    d->length = length;
+    memcpy(d->data, data, length);
+    nettransport_pump(t, now);
+}
+
+// One datagram into `buffer`; 0 when nothing is waiting
+int nettransport_receive(NetTransport* t, void* buffer, int size) {
+    int received = recv(t->socket, (char*)buffer, size, 0);
+    return received > 0 ? received : 0;
+}
+
+// === Rollback session ===
+// Two peers run the same Chip8 in lockstep frames. The keypad each frame is
+// local | remote input. Remote input that has not arrived yet is predicted
+// (the last confirmed value is held), the frame runs anyway, and its start
+// state goes into a ring. When the real input turns out different, the
+// session loads the state of the first mispredicted frame and runs every
+// frame since again: a rollback. A peer more than NETPLAY_MAX_ROLLBACK
+// frames ahead of what it has confirmed stalls instead of predicting more.
+//
+// Every packet carries all local inputs the other side has not acknowledged,
+// so a lost packet is covered by the next one and no retransmit timer is needed.
+typedef struct {
+    uint32_t magic;
+    uint32_t ack;    // remote frames the sender has confirmed (its acknowledgement of ours)
+    uint32_t start;  // frame of inputs[0]
+    uint32_t count;
+    uint16_t inputs[NETPLAY_PACKET_INPUTS];
+} NetPacket;
+
+typedef struct {
+    Chip8State chip8;
+    int slotAccumulator;
+} NetState;
+
+typedef struct {
+    Chip8 chip8;                             // the live machine, at the start of `frame`
+    int slotAccumulator;                     // chip8_runFrame remainder, part of the state
+    NetState states[NETPLAY_STATES];         // machine at the start of frame f, at f % NETPLAY_STATES
+    uint16_t localInput[NETPLAY_HISTORY];    // by frame, & (NETPLAY_HISTORY - 1)
+    uint16_t remoteInput[NETPLAY_HISTORY];   // confirmed below remoteKnown, predicted above
+    uint32_t frame;                          // next frame to run
+    uint32_t localKnown;                     // local inputs recorded for frames below this
+    uint32_t localAcked;                     // ... and the remote peer has those below this
+    uint32_t remoteKnown;                    // remote inputs confirmed for frames below this
+    uint32_t inputDelay;                     // local keys apply this many frames later
+    NetTransport net;
+
+    // Per-frame report of the last netplay_advance
+    uint32_t rollbackDepth;  // frames re-simulated, 0 if the prediction held
+    uint64_t rollbackNs;     // time spent loading the state and re-simulating
+    bool stalled;            // too far ahead of the remote peer: the frame did not run
+
+    // Totals
+    uint32_t rollbacks, resimulated, maxDepth, stalls;
+    uint64_t totalRollbackNs, maxRollbackNs;
+} Netplay;
+
+bool netplay_open(Netplay* n, const Chip8* start, uint16_t localPort, uint16_t remotePort, uint32_t inputDelay) {
+    memset(n, 0, sizeof(*n));
+    chip8_saveState(start, &n->chip8);
+    n->inputDelay = inputDelay;
+    n->localKnown = inputDelay;  // the first frames run with no local keys
+    return nettransport_open(&n->net, localPort, remotePort);
+}
+
+void netplay_close(Netplay* n) {
+    nettransport_close(&n->net);
+}
+
+static uint16_t netplay_remoteFor(const Netplay* n, uint32_t frame) {
+    if (frame < n->remoteKnown) return n->remoteInput[frame & (NETPLAY_HISTORY - 1)];
+    return n->remoteKnown ? n->remoteInput[(n->remoteKnown - 1) & (NETPLAY_HISTORY - 1)] : 0;  // hold the last
+}
+
+// Save the start state of `frame`, then run it
+static void netplay_runFrame(Netplay* n) {
+    NetState* s = &n->states[n->frame & (NETPLAY_STATES - 1)];
+    chip8_saveState(&n->chip8, &s->chip8);
+    s->slotAccumulator = n->slotAccumulator;
+
+    uint16_t remote = netplay_remoteFor(n, n->frame);
+    n->remoteInput[n->frame & (NETPLAY_HISTORY - 1)] = remote;  // what this frame used
+    n->chip8.keys = n->localInput[n->frame & (NETPLAY_HISTORY - 1)] | remote;
+    chip8_runFrame(&n->chip8, &n->slotAccumulator);
+    n->frame++;
+}
+
+static void netplay_sendInputs(Netplay* n, uint64_t now) {
+    NetPacket packet;
+    uint32_t count = n->localKnown - n->localAcked;
+    if (count > NETPLAY_PACKET_INPUTS) count = NETPLAY_PACKET_INPUTS;
+    packet.magic = NETPLAY_MAGIC;
+    packet.ack = n->remoteKnown;
+    packet.start = n->localAcked;
+    packet.count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        packet.inputs[i] = n->localInput[(packet.start + i) & (NETPLAY_HISTORY - 1)];
+    }
+    nettransport_send(&n->net, now, &packet, (int)(offsetof(NetPacket, inputs) + count * sizeof(uint16_t)));
+}
+
+// Take in every waiting packet; returns the first frame whose prediction was
+// wrong, or n->frame if none was
+static uint32_t netplay_receive(Netplay* n) {
+    uint32_t rollbackFrom = n->frame;
+    NetPacket packet;
+    int length;
+    while ((length = nettransport_receive(&n->net, &packet, sizeof(packet))) > 0) {
+        if (length < (int)offsetof(NetPacket, inputs) || packet.magic != NETPLAY_MAGIC ||
+            packet.count > NETPLAY_PACKET_INPUTS ||
+            length < (int)(offsetof(NetPacket, inputs) + packet.count * sizeof(uint16_t))) {
+            continue;
+        }
+        if (packet.ack > n->localAcked && packet.ack <= n->localKnown) n->localAcked = packet.ack;
+
+        // Only a run that continues what we have counts; a gap waits for the resend
+        if (packet.start > n->remoteKnown) continue;
+        for (uint32_t f = n->remoteKnown; f < packet.start + packet.count; f++) {
+            uint16_t input = packet.inputs[f - packet.start];
+            uint16_t* slot = &n->remoteInput[f & (NETPLAY_HISTORY - 1)];
+            if (f < n->frame && *slot != input && f < rollbackFrom) rollbackFrom = f;
+            *slot = input;
+            n->remoteKnown = f + 1;
+        }
+    }
+    return rollbackFrom;
+}
+
+// Confirmed inputs for frames already run that differ from the prediction:
+// go back to the first and run forward again
+static void netplay_rollback(Netplay* n, uint32_t from) {
+    n->rollbackDepth = 0;
+    n->rollbackNs = 0;
+    if (from >= n->frame) return;
+
+    uint64_t start = SDL_GetTicksNS();
+    uint32_t target = n->frame;
+    const NetState* s = &n->states[from & (NETPLAY_STATES - 1)];
+    chip8_loadState(&n->chip8, &s->chip8);
+    n->slotAccumulator = s->slotAccumulator;
+    n->frame = from;
+    while (n->frame < target) netplay_runFrame(n);
+
+    n->rollbackDepth = target - from;
+    n->rollbackNs = SDL_GetTicksNS() - start;
+    n->rollbacks++;
+    n->resimulated += n->rollbackDepth;
+    n->totalRollbackNs += n->rollbackNs;
+    if (n->rollbackDepth > n->maxDepth) n->maxDepth = n->rollbackDepth;
+    if (n->rollbackNs > n->maxRollbackNs) n->maxRollbackNs = n->rollbackNs;
+}
+
+// Receive, correct mispredictions and resend, without running a new frame
+void netplay_poll(Netplay* n, uint64_t now) {
+    nettransport_pump(&n->net, now);
+    netplay_rollback(n, netplay_receive(n));
+    netplay_sendInputs(n, now);
+}
+
+// One frame at caller time `now` with the local keys held right now.
+// Returns false if the session had to stall (see n->stalled).
+bool netplay_advance(Netplay* n, uint16_t localKeys, uint64_t now) {
+    nettransport_pump(&n->net, now);
+    netplay_rollback(n, netplay_receive(n));
+
+    // Also stall rather than let unacknowledged inputs outgrow one packet
+    n->stalled = n->frame >= n->remoteKnown + NETPLAY_MAX_ROLLBACK ||
+                 n->localKnown - n->localAcked >= NETPLAY_PACKET_INPUTS;
+    if (n->stalled) {
+        n->stalls++;
+    } else {
+        n->localInput[n->localKnown++ & (NETPLAY_HISTORY - 1)] = localKeys;
+        netplay_runFrame(n);
+    }
+    netplay_sendInputs(n, now);
+    return !n->stalled;
+}
+
+// True once every frame run so far used confirmed input on both sides of
+// this peer, i.e. the live state is final
+bool netplay_settled(const Netplay* n) {
+    return n->remoteKnown >= n->frame;
+}
+
+static uint64_t netplay_hashField(uint64_t hash, const void* field, size_t size) {
+    return (hash ^ rom_hash(field, size)) * 0x100000001B3ull;  // FNV prime, so field order counts
+}
+
+// Hash of every field the next instruction can depend on: the whole Chip8
+// except the `cycle` pointer, the pending input queue (already folded into
+// `keys` by the time it matters) and the debug-only counters. Field by field,
+// so struct padding never leaks in.
+uint64_t netplay_stateHash(const Chip8* chip8) {
+#define NETPLAY_HASH(field) hash = netplay_hashField(hash, &chip8->field, sizeof(chip8->field))
+    uint64_t hash = 0;
+    NETPLAY_HASH(memory);
+    NETPLAY_HASH(V);
+    NETPLAY_HASH(index);
+    NETPLAY_HASH(pc);
+    NETPLAY_HASH(stack);
+    NETPLAY_HASH(sp);
+    NETPLAY_HASH(delay_timer);
+    NETPLAY_HASH(sound_timer);
+    NETPLAY_HASH(audioPattern);
+    NETPLAY_HASH(hasAudioPattern);
+    NETPLAY_HASH(pitch);
+    NETPLAY_HASH(display);
+    NETPLAY_HASH(hires);
+    NETPLAY_HASH(planes);
+    NETPLAY_HASH(keys);
+    NETPLAY_HASH(clock);
+    NETPLAY_HASH(rpl);
+    NETPLAY_HASH(waitingForKey);
+    NETPLAY_HASH(waitingRegister);
+    NETPLAY_HASH(waitingForVblank);
+    NETPLAY_HASH(rng);
+    NETPLAY_HASH(profile);
+    NETPLAY_HASH(quirks);
+    NETPLAY_HASH(hz);
+    NETPLAY_HASH(fault);
+    NETPLAY_HASH(faultPc);
+#undef NETPLAY_HASH
+    return hash;
+}
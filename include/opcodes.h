@@ -0,0 +1,201 @@
+#pragma once
+#include <header.h>
+
+// === Opcode families ===
+// One entry per instruction form, in decode order (first match wins):
+// X(family, mask, match, flow, mnemonic). The mnemonic is a template for
+// opcode_format: {x} {y} {n} {kk} {nnn} are the decoded fields, {op} the raw opcode.
+// flow tells the disassembler where control can go after the instruction.
+#define CHIP8_OPCODE_FAMILIES(X)                          \
+    X(00E0, 0xFFFF, 0x00E0, NEXT, "CLS")                  \
+    X(00EE, 0xFFFF, 0x00EE, RET, "RET")                   \
+    X(00CN, 0xFFF0, 0x00C0, NEXT, "SCD {n}")              \
+    X(00DN, 0xFFF0, 0x00D0, NEXT, "SCU {n}")              \
+    X(00FB, 0xFFFF, 0x00FB, NEXT, "SCR")                  \
+    X(00FC, 0xFFFF, 0x00FC, NEXT, "SCL")                  \
+    X(00FD, 0xFFFF, 0x00FD, HALT, "EXIT")                 \
+    X(00FE, 0xFFFF, 0x00FE, NEXT, "LOW")                  \
+    X(00FF, 0xFFFF, 0x00FF, NEXT, "HIGH")                 \
+    X(0NNN, 0xF000, 0x0000, NEXT, "SYS {nnn}")            \
+    X(1NNN, 0xF000, 0x1000, JUMP, "JP {nnn}")             \
+    X(2NNN, 0xF000, 0x2000, CALL, "CALL {nnn}")           \
+    X(3XKK, 0xF000, 0x3000, SKIP, "SE V{x}, {kk}")        \
+    X(4XKK, 0xF000, 0x4000, SKIP, "SNE V{x}, {kk}")       \
+    X(5XY0, 0xF00F, 0x5000, SKIP, "SE V{x}, V{y}")        \
+    X(5XY2, 0xF00F, 0x5002, NEXT, "SAVE V{x}..V{y}")      \
+    X(5XY3, 0xF00F, 0x5003, NEXT, "LOAD V{x}..V{y}")      \
+    X(6XKK, 0xF000, 0x6000, NEXT, "LD V{x}, {kk}")        \
+    X(7XKK, 0xF000, 0x7000, NEXT, "ADD V{x}, {kk}")       \
+    X(8XY0, 0xF00F, 0x8000, NEXT, "LD V{x}, V{y}")        \
+    X(8XY1, 0xF00F, 0x8001, NEXT, "OR V{x}, V{y}")        \
+    X(8XY2, 0xF00F, 0x8002, NEXT, "AND V{x}, V{y}")       \
+    X(8XY3, 0xF00F, 0x8003, NEXT, "XOR V{x}, V{y}")       \
+    X(8XY4, 0xF00F, 0x8004, NEXT, "ADD V{x}, V{y}")       \
+    X(8XY5, 0xF00F, 0x8005, NEXT, "SUB V{x}, V{y}")       \
+    X(8XY6, 0xF00F, 0x8006, NEXT, "SHR V{x}")             \
+    X(8XY7, 0xF00F, 0x8007, NEXT, "SUBN V{x}, V{y}")      \
+    X(8XYE, 0xF00F, 0x800E, NEXT, "SHL V{x}")             \
+    X(9XY0, 0xF00F, 0x9000, SKIP, "SNE V{x}, V{y}")       \
+    X(ANNN, 0xF000, 0xA000, DATA, "LD I, {nnn}")          \
+    X(BNNN, 0xF000, 0xB000, INDIRECT, "JP V0, {nnn}")     \
+    X(CXKK, 0xF000, 0xC000, NEXT, "RND V{x}, {kk}")       \
+    X(DXYN, 0xF000, 0xD000, NEXT, "DRW V{x}, V{y}, {n}")  \
+    X(EX9E, 0xF0FF, 0xE09E, SKIP, "SKP V{x}")             \
+    X(EXA1, 0xF0FF, 0xE0A1, SKIP, "SKNP V{x}")            \
+    X(F000, 0xFFFF, 0xF000, LONG, "LD I, LONG")           \
+    X(FN01, 0xF0FF, 0xF001, NEXT, "PLANE {x}")            \
+    X(F002, 0xFFFF, 0xF002, NEXT, "AUDIO")                \
+    X(FX07, 0xF0FF, 0xF007, NEXT, "LD V{x}, DT")          \
+    X(FX0A, 0xF0FF, 0xF00A, NEXT, "LD V{x}, K")           \
+    X(FX15, 0xF0FF, 0xF015, NEXT, "LD DT, V{x}")          \
+    X(FX18, 0xF0FF, 0xF018, NEXT, "LD ST, V{x}")          \
+    X(FX1E, 0xF0FF, 0xF01E, NEXT, "ADD I, V{x}")          \
+    X(FX29, 0xF0FF, 0xF029, NEXT, "LD F, V{x}")           \
+    X(FX30, 0xF0FF, 0xF030, NEXT, "LD HF, V{x}")          \
+    X(FX33, 0xF0FF, 0xF033, NEXT, "LD B, V{x}")           \
+    X(FX3A, 0xF0FF, 0xF03A, NEXT, "PITCH V{x}")           \
+    X(FX55, 0xF0FF, 0xF055, NEXT, "LD [I], V0..V{x}")     \
+    X(FX65, 0xF0FF, 0xF065, NEXT, "LD V0..V{x}, [I]")     \
+    X(FX75, 0xF0FF, 0xF075, NEXT, "LD R, V0..V{x}")       \
+    X(FX85, 0xF0FF, 0xF085, NEXT, "LD V0..V{x}, R")       \
+    X(UNKNOWN, 0x0000, 0x0000, STOP, "DW {op}")
+
+#define OPCODE_FAMILY_ENUM(family, mask, match, flow, mnemonic) OP_##family,
+#define OPCODE_FAMILY_NAME(family, mask, match, flow, mnemonic) #family,
+#define OPCODE_FAMILY_ENTRY(family, mask, match, flow, mnemonic) {mask, match, FLOW_##flow, mnemonic},
+
+typedef enum {
+    FLOW_NEXT,      // falls through to pc + 2
+    FLOW_JUMP,      // 1NNN: continues at nnn only
+    FLOW_CALL,      // 2NNN: enters nnn, returns to pc + 2
+    FLOW_RET,       // 00EE: leaves the subroutine
+    FLOW_SKIP,      // conditional: pc + 2 or pc + 4
+    FLOW_DATA,      // ANNN: falls through, nnn is a data reference
+    FLOW_INDIRECT,  // BNNN: target depends on V0, unknown statically
+    FLOW_HALT,      // 00FD: the interpreter stops here
+    FLOW_LONG,      // F000 NNNN: 4 bytes, falls through to pc + 4, NNNN is a data reference
+    FLOW_STOP,      // not an instruction
+} Chip8OpFlow;
+
+typedef enum { CHIP8_OPCODE_FAMILIES(OPCODE_FAMILY_ENUM) OP_FAMILY_COUNT } Chip8OpFamily;
+
+static const char* const opcodeFamilyNames[OP_FAMILY_COUNT] = {
+    CHIP8_OPCODE_FAMILIES(OPCODE_FAMILY_NAME)};
+
+typedef struct {
+    uint16_t mask;
+    uint16_t match;
+    Chip8OpFlow flow;
+    const char* mnemonic;
+} Chip8OpcodeInfo;
+
+static const Chip8OpcodeInfo opcodeInfo[OP_FAMILY_COUNT] = {
+    CHIP8_OPCODE_FAMILIES(OPCODE_FAMILY_ENTRY)};
+
+// First matching table entry; OP_UNKNOWN matches anything
+Chip8OpFamily opcode_family(uint16_t opcode) {
+    int family = 0;
+    while ((opcode & opcodeInfo[family].mask) != opcodeInfo[family].match) family++;
+    return (Chip8OpFamily)family;
+}
+
+// === Decoder ===
+// The table above expanded once into a 64K opcode -> family map, so decoding
+// in chip8Cycle and the disassembler is a single load.
+static uint8_t opcodeDecodeTable[0x10000];
+static SDL_InitState opcodeDecodeInit;
+
+void opcodes_init(void) {
+    if (!SDL_ShouldInit(&opcodeDecodeInit)) return;  // built already (or by another thread)
+    for (uint32_t opcode = 0; opcode < 0x10000; opcode++) {
+        opcodeDecodeTable[opcode] = (uint8_t)opcode_family((uint16_t)opcode);
+    }
+    SDL_SetInitialized(&opcodeDecodeInit, true);
+}
+
+static inline Chip8OpFamily opcode_decode(uint16_t opcode) {
+    return (Chip8OpFamily)opcodeDecodeTable[opcode];
+}
+
+// Disassemble one opcode into `out`, e.g. "DRW V0, V1, 5"
+void opcode_format(uint16_t opcode, char* out, size_t size) {
+    const char* t = opcodeInfo[opcode_family(opcode)].mnemonic;
+    size_t length = 0;
+
+    while (*t && length + 1 < size) {
+        int written = 0;
+        size_t room = size - length;
+        if (strncmp(t, "{nnn}", 5) == 0) {
+            written = snprintf(out + length, room, "%03X", opcode & 0x0FFF);
+            t += 5;
+        } else if (strncmp(t, "{kk}", 4) == 0) {
+            written = snprintf(out + length, room, "%02X", opcode & 0x00FF);
+            t += 4;
+        } else if (strncmp(t, "{op}", 4) == 0) {
+            written = snprintf(out + length, room, "%04X", opcode);
+            t += 4;
+        } else if (strncmp(t, "{x}", 3) == 0) {
+            written = snprintf(out + length, room, "%X", (opcode & 0x0F00) >> 8);
+            t += 3;
+        } else if (strncmp(t, "{y}", 3) == 0) {
+            written = snprintf(out + length, room, "%X", (opcode & 0x00F0) >> 4);
+            t += 3;
+        } else if (strncmp(t, "{n}", 3) == 0) {
+            written = snprintf(out + length, room, "%X", opcode & 0x000F);
+            t += 3;
+        } else {
+            out[length] = *t++;
+            written = 1;
+        }
+        length += (size_t)written < room ? (size_t)written : room - 1;
+    }
+    out[length] = '\0';
+}
+
+// === Opcode profile (CHIP8_PROFILE_OPCODES builds only) ===
+// Plain per-instance counters filled in by chip8Cycle. With sampleInterval > 0,
+// every Nth instruction is also timed with the performance counter and the host
+// time is charged to its family.
+typedef struct {
+    uint64_t count[OP_FAMILY_COUNT];    // executions per family
+    uint64_t sampled[OP_FAMILY_COUNT];  // timed executions per family
+    uint64_t ticks[OP_FAMILY_COUNT];    // performance-counter ticks over the timed ones
+    uint32_t sampleInterval;            // 0 = counts only
+    uint32_t sampleCountdown;
+} Chip8OpcodeProfile;
+
+double opcodeProfile_nsPerInstruction(const Chip8OpcodeProfile* p, int family) {
+    if (p->sampled[family] == 0) return 0.0;
+    return p->ticks[family] * 1e9 / (double)SDL_GetPerformanceFrequency() / p->sampled[family];
+}
+
+void opcodeProfile_print(const Chip8OpcodeProfile* p, FILE* out) {
+    uint64_t total = 0;
+    for (int f = 0; f < OP_FAMILY_COUNT; f++) total += p->count[f];
+
+    fprintf(out, "%-8s %14s %8s %12s\n", "family", "count", "%", "ns (sampled)");
+    for (int f = 0; f < OP_FAMILY_COUNT; f++) {
+        if (p->count[f] == 0) continue;
+        fprintf(out, "%-8s %14llu %8.2f", opcodeFamilyNames[f],
+                (unsigned long long)p->count[f], 100.0 * p->count[f] / total);
+        if (p->sampled[f]) {
+            fprintf(out, " %12.1f", opcodeProfile_nsPerInstruction(p, f));
+        }
+        fputc('\n', out);
+    }
+    fprintf(out, "%-8s %14llu\n", "total", (unsigned long long)total);
+}
+
+void opcodeProfile_printJson(const Chip8OpcodeProfile* p, FILE* out) {
+    fprintf(out, "{\n  \"sample_interval\": %u,\n  \"families\": {\n", p->sampleInterval);
+    bool first = true;
+    for (int f = 0; f < OP_FAMILY_COUNT; f++) {
+        if (p->count[f] == 0) continue;
+        fprintf(out, "%s    \"%s\": {\"count\": %llu, \"sampled\": %llu, \"ns\": %.1f}",
+                first ? "" : ",\n", opcodeFamilyNames[f],
+                (unsigned long long)p->count[f], (unsigned long long)p->sampled[f],
+                opcodeProfile_nsPerInstruction(p, f));
+        first = false;
+    }
+    fprintf(out, "\n  }\n}\n");
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <chip8.h>
+#include <header.h>
+
+#define PACK_MAGIC "C8PK"
+#define PACK_VERSION 1
+#define PACK_NAME_SIZE 44
+
+// === ROM pack ===
+// A whole corpus in one file, laid out so it can be used straight from a
+// mapping (little-endian, like every target we build for):
+//
+//   PackHeader                  32 bytes
+//   PackEntry[count]            64 bytes each, sorted by content hash
+//   ROM bytes                   concatenated, in index order
+//
+// pack_open maps the file and validates every entry once; after that a ROM
+// is loaded with an index lookup and a memcpy, no system calls.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t indexOffset;
+    uint32_t dataOffset;
+    uint32_t reserved[3];
+} PackHeader;
+
+typedef struct {
+    uint64_t hash;     // rom_hash of the ROM bytes
+    uint32_t offset;   // from the start of the file
+    uint32_t size;
+    uint16_t profile;  // Chip8Profile + 1; 0 = whatever the ROM database says
+    uint16_t reserved;
+    char name[PACK_NAME_SIZE];  // file name it was packed from, NUL-padded
+} PackEntry;
+
+_Static_assert(sizeof(PackHeader) == 32, "PackHeader layout");
+_Static_assert(sizeof(PackEntry) == 64, "PackEntry layout");
+
+typedef struct {
+    RomMapping file;
+    const uint8_t* base;
+    const PackEntry* index;
+    uint32_t count;
+} Pack;
+
+void pack_close(Pack* p) {
+    rom_unmap(&p->file);
+    p->base = NULL;
+    p->index = NULL;
+    p->count = 0;
+}
+
+bool pack_open(Pack* p, const char* filename) {
+    p->base = NULL;
+    p->index = NULL;
+    p->count = 0;
+    if (!rom_map(&p->file, filename)) return false;
+
+    const PackHeader* header = (const PackHeader*)p->file.data;
+    size_t size = p->file.size;
+    if (size < sizeof(PackHeader) || memcmp(header->magic, PACK_MAGIC, 4) != 0 ||
+        header->version != PACK_VERSION) {
+        fprintf(stderr, "%s: not a version %d ROM pack\n", filename, PACK_VERSION);
+        pack_close(p);
+        return false;
+    }
+    if (header->indexOffset > size || header->count > (size - header->indexOffset) / sizeof(PackEntry)) {
+        fprintf(stderr, "%s: truncated index\n", filename);
+        pack_close(p);
+        return false;
+    }
+
+    const PackEntry* index = (const PackEntry*)(p->file.data + header->indexOffset);
+    for (uint32_t i = 0; i < header->count; i++) {
+        if (index[i].offset > size || index[i].size > size - index[i].offset || index[i].size > ROM_MAX_SIZE ||
+            (i && index[i].hash < index[i - 1].hash)) {
+            fprintf(stderr, "%s: bad index entry %u\n", filename, i);
+            pack_close(p);
+            return false;
+        }
+    }
+
+    p->base = p->file.data;
+    p->index = index;
+    p->count = header->count;
+    return true;
+}
+
+// Binary search on the content hash; NULL if the ROM is not in the pack
+const PackEntry* pack_find(const Pack* p, uint64_t hash) {
+    uint32_t low = 0, high = p->count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (p->index[mid].hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return (low < p->count && p->index[low].hash == hash) ? &p->index[low] : NULL;
+}
+
+// By file name (linear: names are for people, hashes for lookups)
+const PackEntry* pack_findName(const Pack* p, const char* name) {
+    for (uint32_t i = 0; i < p->count; i++) {
+        if (strncmp(p->index[i].name, name, PACK_NAME_SIZE) == 0) return &p->index[i];
+    }
+    return NULL;
+}
+
+static inline const uint8_t* pack_data(const Pack* p, const PackEntry* e) {
+    return p->base + e->offset;
+}
+
+int pack_load(const Pack* p, const PackEntry* e, Chip8* chip8) {
+    int size = chip8_loadBuffer(chip8, pack_data(p, e), e->size);
+    if (size >= 0 && e->profile && e->profile <= CHIP8_PROFILE_COUNT) chip8_setProfile(chip8, e->profile - 1, 0);
+    return size;
+}
@@ -3,6 +3,8 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 #include <header.h>
+#include <input.h>
+#include <upscale.h>
 
 #define DISPLAY_WIDTH 64
 #define DISPLAY_HEIGHT 32
@@ -16,8 +18,17 @@ typedef struct {
     SDL_Texture* texture;
     int windowWidth, windowHeight;
     int textureWidth, textureHeight;
+
+    // CPU upscaling (platform_enableUpscale); NULL leaves the stretch to the renderer
+    Upscaler* upscaler;
+    int sourceWidth, sourceHeight;  // frame size the layout below was worked out for
+    int scale;                      // 0 when the window is smaller than one frame
+    SDL_FRect sourceRect, targetRect;
 } Platform;
 
+// Set by platform_processInput when the window's pixel size changes
+static bool platformResized = false;
+
 bool platform_init(Platform* p,
                    const char* title,
                    int windowWidth,
@@ -42,9 +53,62 @@ bool platform_init(Platform* p,
                                    textureHeight);
 
     SDL_SetTextureScaleMode(p->texture, SDL_SCALEMODE_NEAREST);
+    p->upscaler = NULL;
     return true;
 }
 
+// Scale frames on the CPU from now on (platform_updateScaled)
+bool platform_enableUpscale(Platform* p, UpscaleFilter filter, bool scanlines) {
+    p->upscaler = SDL_malloc(sizeof(Upscaler));
+    if (!p->upscaler) return false;
+    upscale_init(p->upscaler, filter, scanlines);
+    p->sourceWidth = p->sourceHeight = 0;  // lay out on the first frame
+    return true;
+}
+
+// Work out the scale for width x height frames in the current window and
+// size the streaming texture to match. Only runs after a resize or when the
+// frame size changes (lores/hires), not per frame.
+static void platform_layout(Platform* p, int width, int height) {
+    int outWidth, outHeight;
+    SDL_GetCurrentRenderOutputSize(p->renderer, &outWidth, &outHeight);
+    p->sourceWidth = width;
+    p->sourceHeight = height;
+    p->scale = upscale_fit(p->upscaler, width, height, outWidth, outHeight);
+
+    int scaledWidth = width * p->scale, scaledHeight = height * p->scale;
+    if (p->scale && (platformResized || scaledWidth > p->textureWidth || scaledHeight > p->textureHeight)) {
+        SDL_DestroyTexture(p->texture);
+        p->texture = SDL_CreateTexture(p->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING,
+                                       scaledWidth, scaledHeight);
+        SDL_SetTextureScaleMode(p->texture, SDL_SCALEMODE_NEAREST);
+        p->textureWidth = scaledWidth;
+        p->textureHeight = scaledHeight;
+    }
+    p->sourceRect = (SDL_FRect){0, 0, (float)scaledWidth, (float)scaledHeight};
+    p->targetRect = (SDL_FRect){(float)((outWidth - scaledWidth) / 2), (float)((outHeight - scaledHeight) / 2),
+                                (float)scaledWidth, (float)scaledHeight};  // centred, 1:1
+    platformResized = false;
+}
+
+// Present width x height RGBA8888 pixels (width a multiple of 4), upscaled
+// into the texture so the renderer only copies it
+void platform_updateScaled(Platform* p, const uint32_t* pixels, int width, int height) {
+    if (platformResized || width != p->sourceWidth || height != p->sourceHeight) {
+        platform_layout(p, width, height);
+    }
+    SDL_RenderClear(p->renderer);
+    void* texels;
+    int pitch;
+    SDL_Rect area = {0, 0, width * p->scale, height * p->scale};
+    if (p->scale && SDL_LockTexture(p->texture, &area, &texels, &pitch)) {
+        upscale_frame(p->upscaler, pixels, width, height, p->scale, texels, pitch);
+        SDL_UnlockTexture(p->texture);
+        SDL_RenderTexture(p->renderer, p->texture, &p->sourceRect, &p->targetRect);
+    }
+    SDL_RenderPresent(p->renderer);
+}
+
 // Update screen with framebuffer
 void platform_update(Platform* p, const void* buffer, int pitch) {
     SDL_SetTextureScaleMode(p->texture, SDL_SCALEMODE_NEAREST);
@@ -56,131 +120,63 @@ void platform_update(Platform* p, const void* buffer, int pitch) {
 
 // Destroy Platform
 void platform_destroy(Platform* p) {
+    SDL_free(p->upscaler);
     if (p->texture) SDL_DestroyTexture(p->texture);
     if (p->renderer) SDL_DestroyRenderer(p->renderer);
     if (p->window) SDL_DestroyWindow(p->window);
     SDL_Quit();
 }
 
-// Input handling (CHIP-8 keypad mapping)
-bool platform_processInput(uint8_t* keys) {
+// Frontend controls outside the CHIP-8 keypad
+typedef enum {
+    PLATFORM_CONTROL_NONE,
+    PLATFORM_CONTROL_PAUSE,       // F5: pause / continue
+    PLATFORM_CONTROL_STEP,        // F10: run one instruction while paused
+    PLATFORM_CONTROL_BREAKPOINT,  // F9: toggle a breakpoint at the current PC
+} PlatformControl;
+
+// CHIP-8 key k sits under platformKeymap[k] (the usual 1234/QWER/ASDF/ZXCV block)
+static const SDL_Keycode platformKeymap[16] = {
+    SDLK_X, SDLK_1, SDLK_2, SDLK_3, SDLK_Q, SDLK_W, SDLK_E, SDLK_A,
+    SDLK_S, SDLK_D, SDLK_Z, SDLK_C, SDLK_4, SDLK_R, SDLK_F, SDLK_V,
+};
+
+// Input handling: keypad changes are queued to take effect at emulated time
+// `clock`, nothing touches the interpreter directly; `control` may be NULL
+bool platform_processInput(InputQueue* input, uint64_t clock, PlatformControl* control) {
     SDL_Event event;
     bool quit = false;
+    if (control) *control = PLATFORM_CONTROL_NONE;
 
     while (SDL_PollEvent(&event)) {
         switch (event.type) {
             case SDL_EVENT_QUIT:
                 quit = true;
                 break;
-            case SDL_EVENT_KEY_DOWN: {
-                bool isDown = (event.type == SDL_EVENT_KEY_DOWN);
-                switch (event.key.key) {  // SDL_Event.SDL_KeyboardEvent.SDL_Keycode
-                    case SDLK_ESCAPE:
-                        quit = true;
-                        break;
-                    case SDLK_X:
-                        keys[0x0] = isDown;
-                        break;
-                    case SDLK_1:
-                        keys[0x1] = isDown;
-                        break;
-                    case SDLK_2:
-                        keys[0x2] = isDown;
-                        break;
-                    case SDLK_3:
-                        keys[0x3] = isDown;
-                        break;
-                    case SDLK_Q:
-                        keys[0x4] = isDown;
-                        break;
-                    case SDLK_W:
-                        keys[0x5] = isDown;
-                        break;
-                    case SDLK_E:
-                        keys[0x6] = isDown;
-                        break;
-                    case SDLK_A:
-                        keys[0x7] = isDown;
-                        break;
-                    case SDLK_S:
-                        keys[0x8] = isDown;
-                        break;
-                    case SDLK_D:
-                        keys[0x9] = isDown;
-                        break;
-                    case SDLK_Z:
-                        keys[0xA] = isDown;
-                        break;
-                    case SDLK_C:
-                        keys[0xB] = isDown;
-                        break;
-                    case SDLK_4:
-                        keys[0xC] = isDown;
-                        break;
-                    case SDLK_R:
-                        keys[0xD] = isDown;
-                        break;
-                    case SDLK_F:
-                        keys[0xE] = isDown;
-                        break;
-                    case SDLK_V:
-                        keys[0xF] = isDown;
-                        break;
-                }
-            } break;
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                platformResized = true;
+                break;
+            case SDL_EVENT_KEY_DOWN:
             case SDL_EVENT_KEY_UP: {
-                bool isUp = (event.type == SDL_EVENT_KEY_UP);
-                switch (event.key.key) {  // SDL_Event.SDL_KeyboardEvent.SDL_Keycode
+                bool isDown = (event.type == SDL_EVENT_KEY_DOWN);
+                if (event.key.repeat) break;  // held keys are already down
+                switch (event.key.key) {      // SDL_Event.SDL_KeyboardEvent.SDL_Keycode
                     case SDLK_ESCAPE:
                         quit = true;
                         break;
-                    case SDLK_X:
-                        keys[0x0] = isUp;
-                        break;
-                    case SDLK_1:
-                        keys[0x1] = isUp;
-                        break;
-                    case SDLK_2:
-                        keys[0x2] = isUp;
-                        break;
-                    case SDLK_3:
-                        keys[0x3] = isUp;
-                        break;
-                    case SDLK_Q:
-                        keys[0x4] = isUp;
-                        break;
-                    case SDLK_W:
-                        keys[0x5] = isUp;
-                        break;
-                    case SDLK_E:
-                        keys[0x6] = isUp;
-                        break;
-                    case SDLK_A:
-                        keys[0x7] = isUp;
-                        break;
-                    case SDLK_S:
-                        keys[0x8] = isUp;
-                        break;
-                    case SDLK_D:
-                        keys[0x9] = isUp;
-                        break;
-                    case SDLK_Z:
-                        keys[0xA] = isUp;
-                        break;
-                    case SDLK_C:
-                        keys[0xB] = isUp;
-                        break;
-                    case SDLK_4:
-                        keys[0xC] = isUp;
+                    case SDLK_F5:
+                        if (control && isDown) *control = PLATFORM_CONTROL_PAUSE;
                         break;
-                    case SDLK_R:
-                        keys[0xD] = isUp;
+                    case SDLK_F10:
+                        if (control && isDown) *control = PLATFORM_CONTROL_STEP;
                         break;
-                    case SDLK_F:
-                        keys[0xE] = isUp;
+                    case SDLK_F9:
+                        if (control && isDown) *control = PLATFORM_CONTROL_BREAKPOINT;
                         break;
-                    case SDLK_V:
-                        keys[0xF] = isUp;
+                    default:
+                        for (uint8_t key = 0; key < 16; key++) {
+                            if (platformKeymap[key] == event.key.key) input_push(input, clock, key, isDown);
+                        }
                         break;
                 }
             } break;
@@ -0,0 +1,163 @@
+#pragma once
+#include <chip8.h>
+#include <header.h>
+#include <opcodes.h>
+
+#define PROFILER_MAX_NODES 4096
+#define PROFILER_ROOT 0x200  // "main": whatever runs outside any subroutine
+
+// === Guest profiler ===
+// Heat map: instructions executed per PC. Subroutines: a calling-context tree
+// built from a shadow call stack that follows 2NNN/00EE; every instruction is
+// charged to the node of the current call path. From the tree we get folded
+// stacks (flamegraph.pl input) and per-subroutine inclusive/exclusive counts.
+typedef struct {
+    uint16_t entry;   // subroutine address
+    int parent;       // -1 for the root
+    int firstChild;
+    int nextSibling;
+    uint64_t self;    // instructions executed directly in this context
+} ProfilerNode;
+
+typedef struct {
+    uint64_t pcCount[MEM_SIZE];
+    ProfilerNode nodes[PROFILER_MAX_NODES];
+    int nodeCount;
+    int current;        // node of the call path being executed
+    int untracked;      // calls entered below `current` without a node; their RETs pop nothing
+    uint64_t overflow;  // calls not tracked because the node pool was full
+    uint64_t total;
+} Profiler;
+
+void profiler_init(Profiler* p) {
+    memset(p->pcCount, 0, sizeof(p->pcCount));
+    p->nodes[0] = (ProfilerNode){PROFILER_ROOT, -1, -1, -1, 0};
+    p->nodeCount = 1;
+    p->current = 0;
+    p->untracked = 0;
+    p->overflow = 0;
+    p->total = 0;
+}
+
+static int profiler_child(Profiler* p, int parent, uint16_t entry) {
+    for (int c = p->nodes[parent].firstChild; c >= 0; c = p->nodes[c].nextSibling) {
+        if (p->nodes[c].entry == entry) return c;
+    }
+    if (p->nodeCount == PROFILER_MAX_NODES) return -1;
+
+    int c = p->nodeCount++;
+    p->nodes[c] = (ProfilerNode){entry, parent, -1, p->nodes[parent].firstChild, 0};
+    p->nodes[parent].firstChild = c;
+    return c;
+}
+
+// Call before chip8Cycle executes the instruction at chip8->pc
+void profiler_step(Profiler* p, const Chip8* chip8) {
+    uint16_t pc = chip8->pc & (MEM_SIZE - 1);
+    uint16_t opcode = chip8->memory[pc] << 8 | chip8->memory[(pc + 1) & (MEM_SIZE - 1)];
+
+    p->pcCount[pc]++;
+    p->nodes[p->current].self++;
+    p->total++;
+
+    if ((opcode & 0xF000) == 0x2000) {  // CALL: descend into the callee's context
+        // Once a call goes untracked, everything under it is charged to `current`
+        int child = p->untracked ? -1 : profiler_child(p, p->current, opcode & 0x0FFF);
+        if (child >= 0) {
+            p->current = child;
+        } else {
+            p->untracked++;
+            p->overflow++;
+        }
+    } else if (opcode == 0x00EE) {  // RET: leave the untracked calls first
+        if (p->untracked) {
+            p->untracked--;
+        } else if (p->nodes[p->current].parent >= 0) {
+            p->current = p->nodes[p->current].parent;
+        }
+    }
+}
+
+static void profiler_nodeName(uint16_t entry, char* out, size_t size) {
+    if (entry == PROFILER_ROOT) {
+        snprintf(out, size, "main");
+    } else {
+        snprintf(out, size, "sub_%03X", entry);
+    }
+}
+
+static void profiler_foldNode(const Profiler* p, int node, char* path, size_t length, FILE* out) {
+    char name[16];
+    profiler_nodeName(p->nodes[node].entry, name, sizeof(name));
+    int written = snprintf(path + length, 1024 - length, "%s%s", length ? ";" : "", name);
+    if (written < 0 || length + written >= 1024) return;  // absurdly deep: drop the branch
+
+    size_t newLength = length + written;
+    if (p->nodes[node].self) fprintf(out, "%s %llu\n", path, (unsigned long long)p->nodes[node].self);
+    for (int c = p->nodes[node].firstChild; c >= 0; c = p->nodes[c].nextSibling) {
+        profiler_foldNode(p, c, path, newLength, out);
+    }
+    path[length] = '\0';
+}
+
+// Folded stacks, one "main;sub_2A4;sub_30C count" line per call path
+void profiler_writeFolded(const Profiler* p, FILE* out) {
+    char path[1024] = "";
+    profiler_foldNode(p, 0, path, 0, out);
+}
+
+// Subtree total of `node`; adds it to inclusive[entry] unless the same
+// subroutine is already further up the path (recursion is counted once).
+static uint64_t profiler_accumulate(const Profiler* p, int node, uint64_t* inclusive,
+                                    uint64_t* exclusive, uint8_t* onPath) {
+    uint16_t entry = p->nodes[node].entry;
+    uint64_t subtree = p->nodes[node].self;
+
+    onPath[entry]++;
+    for (int c = p->nodes[node].firstChild; c >= 0; c = p->nodes[c].nextSibling) {
+        subtree += profiler_accumulate(p, c, inclusive, exclusive, onPath);
+    }
+    onPath[entry]--;
+
+    exclusive[entry] += p->nodes[node].self;
+    if (onPath[entry] == 0) inclusive[entry] += subtree;
+    return subtree;
+}
+
+// Annotated disassembly of [start, end): per-line counts, subroutine headers
+// with inclusive/exclusive totals
+void profiler_writeListing(const Profiler* p, const Chip8* chip8, uint16_t start, uint16_t end, FILE* out) {
+    static uint64_t inclusive[MEM_SIZE], exclusive[MEM_SIZE];
+    static uint8_t onPath[MEM_SIZE];
+    memset(inclusive, 0, sizeof(inclusive));
+    memset(exclusive, 0, sizeof(exclusive));
+    memset(onPath, 0, sizeof(onPath));
+    profiler_accumulate(p, 0, inclusive, exclusive, onPath);
+
+    double total = p->total ? (double)p->total : 1.0;
+    fprintf(out, "%-6s %-6s %-22s %12s %7s\n", "addr", "opcode", "instruction", "count", "%");
+
+    for (uint32_t address = start; address < end; address++) {
+        // Even addresses always; odd ones only if code actually ran there
+        if ((address & 1) && p->pcCount[address] == 0) continue;
+
+        if (inclusive[address] || address == PROFILER_ROOT) {
+            char name[16];
+            profiler_nodeName(address, name, sizeof(name));
+            fprintf(out, "\n%s:  inclusive %llu (%.1f%%), exclusive %llu (%.1f%%)\n", name,
+                    (unsigned long long)inclusive[address], 100.0 * inclusive[address] / total,
+                    (unsigned long long)exclusive[address], 100.0 * exclusive[address] / total);
+        }
+
+        uint16_t opcode = chip8->memory[address] << 8 | chip8->memory[(address + 1) & (MEM_SIZE - 1)];
+        char text[32];
+        opcode_format(opcode, text, sizeof(text));
+        if (p->pcCount[address]) {
+            fprintf(out, "%03X    %04X   %-22s %12llu %7.2f\n", address, opcode, text,
+                    (unsigned long long)p->pcCount[address], 100.0 * p->pcCount[address] / total);
+        } else {
+            fprintf(out, "%03X    %04X   %-22s %12s\n", address, opcode, text, ".");
+        }
+        if (!(address & 1)) address++;  // step over the second opcode byte
+    }
+}
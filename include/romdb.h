@@ -0,0 +1,96 @@
+#pragma once
+#include <header.h>
+
+// === Quirks ===
+// Behaviours that differ between CHIP-8 interpreters. A clear bit is what
+// this emulator has always done.
+#define CHIP8_QUIRK_SHIFT_VY 0x01          // 8XY6/8XYE shift Vy into Vx (COSMAC VIP), else shift Vx
+#define CHIP8_QUIRK_MEMORY_INCREMENT 0x02  // FX55/FX65 leave I at I + X + 1, else I is unchanged
+#define CHIP8_QUIRK_JUMP_VX 0x04           // BNNN jumps to XNN + Vx (SUPER-CHIP), else NNN + V0
+#define CHIP8_QUIRK_CLIP 0x08              // sprites clip at the screen edge, else they wrap
+#define CHIP8_QUIRK_VF_RESET 0x10          // 8XY1/8XY2/8XY3 clear VF (COSMAC VIP)
+#define CHIP8_QUIRK_DISPLAY_WAIT 0x20      // DXYN waits for the next 60 Hz tick (COSMAC VIP)
+#define CHIP8_QUIRK_LONG_SKIP 0x40         // skips step over F000 NNNN as one 4-byte instruction (XO-CHIP)
+
+// === Profiles ===
+// X(profile, quirks, hz, description); hz is instructions per second
+#define CHIP8_PROFILES(X)                                                                        \
+    X(DEFAULT, CHIP8_QUIRK_CLIP, 500, "this emulator's original behaviour")                      \
+    X(COSMAC,                                                                                    \
+      CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_MEMORY_INCREMENT | CHIP8_QUIRK_CLIP |                   \
+          CHIP8_QUIRK_VF_RESET | CHIP8_QUIRK_DISPLAY_WAIT,                                       \
+      500, "COSMAC VIP CHIP-8")                                                                  \
+    X(SCHIP, CHIP8_QUIRK_JUMP_VX | CHIP8_QUIRK_CLIP, 1000, "SUPER-CHIP 1.1")                     \
+    X(XOCHIP, CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_MEMORY_INCREMENT | CHIP8_QUIRK_LONG_SKIP, 1000,   \
+      "XO-CHIP (Octo)")
+
+#define CHIP8_PROFILE_ENUM(profile, quirks, hz, description) CHIP8_PROFILE_##profile,
+#define CHIP8_PROFILE_ENTRY(profile, quirks, hz, description) {#profile, quirks, hz, description},
+
+typedef enum { CHIP8_PROFILES(CHIP8_PROFILE_ENUM) CHIP8_PROFILE_COUNT } Chip8Profile;
+
+typedef struct {
+    const char* name;
+    uint8_t quirks;
+    uint16_t hz;
+    const char* description;
+} Chip8ProfileInfo;
+
+static const Chip8ProfileInfo chip8Profiles[CHIP8_PROFILE_COUNT] = {CHIP8_PROFILES(CHIP8_PROFILE_ENTRY)};
+
+// Case-insensitive name lookup, for command-line overrides; -1 if unknown
+int chip8_profileByName(const char* name) {
+    for (int p = 0; p < CHIP8_PROFILE_COUNT; p++) {
+        if (SDL_strcasecmp(chip8Profiles[p].name, name) == 0) return p;
+    }
+    return -1;
+}
+
+// === ROM database ===
+// Known ROMs by rom_hash of their bytes. hz 0 takes the profile's rate.
+typedef struct {
+    uint64_t hash;
+    Chip8Profile profile;
+    uint16_t hz;
+    const char* name;
+} RomDbEntry;
+
+static const RomDbEntry romDbEntries[] = {
+    {0xF29EDA105324F103ull, CHIP8_PROFILE_DEFAULT, 0, "Timendus: CHIP-8 splash screen"},
+    {0x7CE94F81F0DDB2F2ull, CHIP8_PROFILE_DEFAULT, 0, "IBM logo"},
+    {0xCED34281D9DAE5C0ull, CHIP8_PROFILE_DEFAULT, 0, "Timendus: corax+ opcode test"},
+    {0x518C0287840C0507ull, CHIP8_PROFILE_DEFAULT, 0, "Timendus: flags test"},
+    {0x24DC4A340AF2A8FBull, CHIP8_PROFILE_COSMAC, 0, "Timendus: quirks test"},
+    {0x95A428AECB4E63AAull, CHIP8_PROFILE_DEFAULT, 0, "Timendus: keypad test"},
+    {0x290DA31D50161491ull, CHIP8_PROFILE_DEFAULT, 0, "Timendus: beep test"},
+    {0xB7BC6CF39B4833D0ull, CHIP8_PROFILE_SCHIP, 0, "Timendus: scrolling test"},
+    {0xB45B7F671FD4E77Bull, CHIP8_PROFILE_DEFAULT, 0, "corax89: test_opcode"},
+};
+
+#define ROMDB_SLOTS 64  // power of two, at least twice the entry count
+_Static_assert(ROMDB_SLOTS >= 2 * SDL_arraysize(romDbEntries), "grow ROMDB_SLOTS");
+
+// Open addressing on the low hash bits; FNV-1a output is already well mixed,
+// so a lookup is one probe in practice. Index + 1 per slot, 0 = empty.
+static uint8_t romDbSlots[ROMDB_SLOTS];
+static SDL_InitState romDbInit;
+
+void romdb_init(void) {
+    if (!SDL_ShouldInit(&romDbInit)) return;
+    for (size_t i = 0; i < SDL_arraysize(romDbEntries); i++) {
+        uint32_t slot = romDbEntries[i].hash & (ROMDB_SLOTS - 1);
+        while (romDbSlots[slot]) slot = (slot + 1) & (ROMDB_SLOTS - 1);
+        romDbSlots[slot] = (uint8_t)(i + 1);
+    }
+    SDL_SetInitialized(&romDbInit, true);
+}
+
+// NULL for ROMs we know nothing about
+const RomDbEntry* romdb_lookup(uint64_t hash) {
+    romdb_init();
+    for (uint32_t slot = hash & (ROMDB_SLOTS - 1); romDbSlots[slot]; slot = (slot + 1) & (ROMDB_SLOTS - 1)) {
+        const RomDbEntry* e = &romDbEntries[romDbSlots[slot] - 1];
+        if (e->hash == hash) return e;
+    }
+    return NULL;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <header.h>
+
+#define TRACE_MAGIC "C8TR"
+#define TRACE_VERSION 1
+#define TRACE_RING_SIZE (1u << 20)  // records in flight (16 MB), more than a writer's sleep produces
+#define TRACE_BATCH 256             // records written before the writer is told; power of two
+#define TRACE_REG_I 0x10            // TraceRecord.reg: I changed
+#define TRACE_REG_NONE 0xFF         // ... no register changed
+
+// === Instruction trace ===
+// One fixed-size binary record per instruction, appended by the interpreter
+// (built with CHIP8_TRACE, make TRACE=1) to a single-producer/single-consumer
+// ring. A writer thread drains the ring to disk in large fwrites, so the
+// emulator never formats text or makes a syscall per instruction. The ring
+// only learns of new records every TRACE_BATCH of them, which keeps the
+// atomic store off the common path. A full ring makes the emulator wait for
+// the writer rather than lose records; `waits` counts how often that happened.
+// The tracedump tool turns a file back into mnemonics.
+typedef struct {
+    uint64_t clock;   // chip8->clock after the instruction's slot
+    uint16_t pc;      // address it was fetched from
+    uint16_t opcode;
+    uint8_t reg;      // register it changed: 0-F for Vx, TRACE_REG_I or TRACE_REG_NONE
+    uint8_t fault;    // Chip8Fault it raised
+    uint16_t value;   // that register's new value
+} TraceRecord;
+
+_Static_assert(sizeof(TraceRecord) == 16, "TraceRecord is a file format");
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+} TraceHeader;
+
+typedef struct {
+    FILE* file;
+    SDL_Thread* thread;
+    SDL_AtomicInt head;     // next record the writer takes (writer owned)
+    SDL_AtomicInt tail;     // records handed to the writer (emulator owned)
+    SDL_AtomicInt closing;
+
+    // emulator side
+    uint64_t next;      // records appended, published to `tail` a batch at a time
+    uint32_t headSeen;  // last `head` read; refreshed only when the ring looks full
+    uint32_t waits;     // times the ring was full
+
+    TraceRecord ring[TRACE_RING_SIZE];
+} TraceLog;
+
+static int trace_writer(void* data) {
+    TraceLog* t = data;
+    for (;;) {
+        bool closing = SDL_GetAtomicInt(&t->closing);  // before tail: the last publish precedes closing
+        uint32_t head = (uint32_t)SDL_GetAtomicInt(&t->head);
+        uint32_t tail = (uint32_t)SDL_GetAtomicInt(&t->tail);
+        if (head == tail) {
+            if (closing) break;
+            SDL_Delay(1);
+            continue;
+        }
+        // Everything waiting up to the end of the ring, in one write
+        uint32_t start = head & (TRACE_RING_SIZE - 1);
+        uint32_t count = SDL_min(tail - head, TRACE_RING_SIZE - start);
+        fwrite(&t->ring[start], sizeof(TraceRecord), count, t->file);
+        SDL_SetAtomicInt(&t->head, (int)(head + count));  // hand the records' slots back
+    }
+    return 0;
+}
+
+bool trace_open(TraceLog* t, const char* filename) {
+    t->file = fopen(filename, "wb");
+    if (!t->file) {
+        perror("Failed to create trace");
+        return false;
+    }
+    TraceHeader header = {{0}, TRACE_VERSION, sizeof(TraceRecord), 0};
+    memcpy(header.magic, TRACE_MAGIC, 4);
+    fwrite(&header, sizeof(header), 1, t->file);
+
+    SDL_SetAtomicInt(&t->head, 0);
+    SDL_SetAtomicInt(&t->tail, 0);
+    SDL_SetAtomicInt(&t->closing, 0);
+    t->next = t->headSeen = 0;
+    t->waits = 0;
+    t->thread = SDL_CreateThread(trace_writer, "trace", t);
+    if (!t->thread) {
+        fprintf(stderr, "Failed to start trace writer: %s\n", SDL_GetError());
+        fclose(t->file);
+        return false;
+    }
+    return true;
+}
+
+// Emulator side: out of room. The writer is awake and draining by now, so
+// spin until it frees a slot.
+static void trace_waitForRoom(TraceLog* t) {
+    uint32_t next = (uint32_t)t->next;
+    SDL_SetAtomicInt(&t->tail, (int)next);
+    t->headSeen = (uint32_t)SDL_GetAtomicInt(&t->head);
+    if (next - t->headSeen < TRACE_RING_SIZE) return;
+    t->waits++;
+    while (next - (t->headSeen = (uint32_t)SDL_GetAtomicInt(&t->head)) == TRACE_RING_SIZE) {
+        SDL_CPUPauseInstruction();
+    }
+}
+
+static inline void trace_append(TraceLog* t, const TraceRecord* record) {
+    uint64_t next = t->next;
+    if ((uint32_t)next - t->headSeen == TRACE_RING_SIZE) trace_waitForRoom(t);
+    t->ring[next & (TRACE_RING_SIZE - 1)] = *record;
+    t->next = ++next;
+    if ((next & (TRACE_BATCH - 1)) == 0) SDL_SetAtomicInt(&t->tail, (int)(uint32_t)next);
+}
+
+// Write out everything still in the ring and close the file. Returns the
+// number of records in it.
+uint64_t trace_close(TraceLog* t) {
+    SDL_SetAtomicInt(&t->tail, (int)(uint32_t)t->next);
+    SDL_SetAtomicInt(&t->closing, 1);
+    SDL_WaitThread(t->thread, NULL);
+    fclose(t->file);
+    return t->next;
+}
@@ -0,0 +1,250 @@
+#pragma once
+#include <emmintrin.h>  // SSE2, always there on x86-64
+#include <header.h>
+
+#define UPSCALE_MAX_SOURCE_WIDTH 128  // SUPER-CHIP hires; widths must be multiples of 4
+#define UPSCALE_MAX_SOURCE_HEIGHT 64
+#define UPSCALE_MAX_SCALE 32
+
+// === CPU upscaler ===
+// Turns a frame of 32-bit pixels into its integer-scaled image, written
+// straight into a streaming texture that is then shown 1:1, so the renderer
+// never stretches anything. A filter first scales by its own factor (edge
+// smoothing in Scale2x/Scale3x); nearest neighbour makes up the rest of the
+// scale. Everything runs on four pixels at a time with SSE2.
+//
+// X(filter, factor, description)
+#define UPSCALE_FILTERS(X)                                    \
+    X(NEAREST, 1, "nearest neighbour, square pixels")          \
+    X(SCALE2X, 2, "Scale2x edge smoothing, then nearest")      \
+    X(SCALE3X, 3, "Scale3x edge smoothing, then nearest")
+
+#define UPSCALE_FILTER_ENUM(filter, factor, description) UPSCALE_##filter,
+#define UPSCALE_FILTER_ENTRY(filter, factor, description) {#filter, factor, description},
+
+typedef enum { UPSCALE_FILTERS(UPSCALE_FILTER_ENUM) UPSCALE_FILTER_COUNT } UpscaleFilter;
+
+typedef struct {
+    const char* name;
+    int factor;
+    const char* description;
+} UpscaleFilterInfo;
+
+static const UpscaleFilterInfo upscaleFilters[UPSCALE_FILTER_COUNT] = {UPSCALE_FILTERS(UPSCALE_FILTER_ENTRY)};
+
+// Case-insensitive name lookup, for command-line options; -1 if unknown
+int upscale_filterByName(const char* name) {
+    for (int f = 0; f < UPSCALE_FILTER_COUNT; f++) {
+        if (SDL_strcasecmp(upscaleFilters[f].name, name) == 0) return f;
+    }
+    return -1;
+}
+
+#define UPSCALE_PADDED_WIDTH (UPSCALE_MAX_SOURCE_WIDTH + 2)
+#define UPSCALE_FILTERED_PIXELS (UPSCALE_MAX_SOURCE_WIDTH * UPSCALE_MAX_SOURCE_HEIGHT * 9)
+
+typedef struct {
+    UpscaleFilter filter;
+    bool scanlines;  // darken the last output row of every source row
+    // Source with its edge pixels repeated one step outwards, so every pixel
+    // has all eight neighbours and the filter loops need no edge cases
+    uint32_t padded[(UPSCALE_MAX_SOURCE_HEIGHT + 2) * UPSCALE_PADDED_WIDTH];
+    uint32_t filtered[UPSCALE_FILTERED_PIXELS];  // filter output, before the nearest stage
+} Upscaler;
+
+void upscale_init(Upscaler* u, UpscaleFilter filter, bool scanlines) {
+    u->filter = filter;
+    u->scanlines = scanlines;
+}
+
+// Largest total scale that fits width x height into outWidth x outHeight,
+// rounded down to a multiple of the filter's factor; 0 if even 1x does not fit.
+// A window too small for the filter gets plain nearest.
+int upscale_fit(const Upscaler* u, int width, int height, int outWidth, int outHeight) {
+    int scale = SDL_min(outWidth / width, outHeight / height);
+    scale = SDL_min(scale, UPSCALE_MAX_SCALE);
+    int factor = upscaleFilters[u->filter].factor;
+    return scale >= factor ? scale - scale % factor : scale;
+}
+
+static inline __m128i upscale_select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Output rows of 2 or 3 pixels per source pixel, four source pixels at a time
+static inline void upscale_store2(uint32_t* out, __m128i a, __m128i b) {
+    _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi32(a, b));
+    _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi32(a, b));
+}
+
+static inline void upscale_store3(uint32_t* out, __m128i a, __m128i b, __m128i c) {
+    __m128 ab = _mm_castsi128_ps(_mm_unpacklo_epi32(a, b));   // a0 b0 a1 b1
+    __m128 abHi = _mm_castsi128_ps(_mm_unpackhi_epi32(a, b));  // a2 b2 a3 b3
+    __m128 ca = _mm_castsi128_ps(_mm_unpacklo_epi32(c, a));   // c0 a0 c1 a1
+    __m128 caHi = _mm_castsi128_ps(_mm_unpackhi_epi32(c, a));  // c2 a2 c3 a3
+    __m128 bc = _mm_castsi128_ps(_mm_unpacklo_epi32(b, c));   // b0 c0 b1 c1
+    __m128 bcHi = _mm_castsi128_ps(_mm_unpackhi_epi32(b, c));  // b2 c2 b3 c3
+    _mm_storeu_ps((float*)out, _mm_shuffle_ps(ab, ca, _MM_SHUFFLE(3, 0, 1, 0)));            // a0 b0 c0 a1
+    _mm_storeu_ps((float*)(out + 4), _mm_shuffle_ps(bc, abHi, _MM_SHUFFLE(1, 0, 3, 2)));    // b1 c1 a2 b2
+    _mm_storeu_ps((float*)(out + 8), _mm_shuffle_ps(caHi, bcHi, _MM_SHUFFLE(3, 2, 3, 0)));  // c2 a3 b3 c3
+}
+
+static void upscale_pad(Upscaler* u, const uint32_t* src, int width, int height) {
+    for (int y = -1; y <= height; y++) {
+        const uint32_t* row = &src[SDL_clamp(y, 0, height - 1) * width];
+        uint32_t* out = &u->padded[(y + 1) * UPSCALE_PADDED_WIDTH];
+        out[0] = row[0];
+        memcpy(out + 1, row, width * sizeof(uint32_t));
+        out[width + 1] = row[width - 1];
+    }
+}
+
+// Neighbours of four pixels:  A B C
+//                             D E F
+//                             G H I
+typedef struct {
+    __m128i a, b, c, d, e, f, g, h, i;
+} UpscaleNeighbours;
+
+static inline UpscaleNeighbours upscale_neighbours(const uint32_t* centre) {
+    const uint32_t* up = centre - UPSCALE_PADDED_WIDTH;
+    const uint32_t* down = centre + UPSCALE_PADDED_WIDTH;
+    UpscaleNeighbours n;
+    n.a = _mm_loadu_si128((const __m128i*)(up - 1));
+    n.b = _mm_loadu_si128((const __m128i*)up);
+    n.c = _mm_loadu_si128((const __m128i*)(up + 1));
+    n.d = _mm_loadu_si128((const __m128i*)(centre - 1));
+    n.e = _mm_loadu_si128((const __m128i*)centre);
+    n.f = _mm_loadu_si128((const __m128i*)(centre + 1));
+    n.g = _mm_loadu_si128((const __m128i*)(down - 1));
+    n.h = _mm_loadu_si128((const __m128i*)down);
+    n.i = _mm_loadu_si128((const __m128i*)(down + 1));
+    return n;
+}
+
+// Scale2x: where B != H and D != F, a corner takes the colour of the two
+// edge neighbours it touches if they match; everything else stays E
+static void upscale_scale2x(Upscaler* u, int width, int height) {
+    int pitch = width * 2;
+    for (int y = 0; y < height; y++) {
+        uint32_t* out = &u->filtered[y * 2 * pitch];
+        for (int x = 0; x < width; x += 4) {
+            UpscaleNeighbours n = upscale_neighbours(&u->padded[(y + 1) * UPSCALE_PADDED_WIDTH + x + 1]);
+            __m128i edge = _mm_andnot_si128(_mm_cmpeq_epi32(n.b, n.h),
+                                            _mm_andnot_si128(_mm_cmpeq_epi32(n.d, n.f), _mm_set1_epi32(-1)));
+            __m128i e0 = upscale_select(_mm_and_si128(edge, _mm_cmpeq_epi32(n.d, n.b)), n.d, n.e);
+            __m128i e1 = upscale_select(_mm_and_si128(edge, _mm_cmpeq_epi32(n.b, n.f)), n.f, n.e);
+            __m128i e2 = upscale_select(_mm_and_si128(edge, _mm_cmpeq_epi32(n.d, n.h)), n.d, n.e);
+            __m128i e3 = upscale_select(_mm_and_si128(edge, _mm_cmpeq_epi32(n.h, n.f)), n.f, n.e);
+            upscale_store2(&out[x * 2], e0, e1);
+            upscale_store2(&out[pitch + x * 2], e2, e3);
+        }
+    }
+}
+
+// Scale3x: the same corners, and each edge middle follows a matching
+// corner pair unless E already continues the diagonal beyond it
+static void upscale_scale3x(Upscaler* u, int width, int height) {
+    int pitch = width * 3;
+    for (int y = 0; y < height; y++) {
+        uint32_t* out = &u->filtered[y * 3 * pitch];
+        for (int x = 0; x < width; x += 4) {
+            UpscaleNeighbours n = upscale_neighbours(&u->padded[(y + 1) * UPSCALE_PADDED_WIDTH + x + 1]);
+            __m128i edge = _mm_andnot_si128(_mm_cmpeq_epi32(n.b, n.h),
+                                            _mm_andnot_si128(_mm_cmpeq_epi32(n.d, n.f), _mm_set1_epi32(-1)));
+            __m128i db = _mm_and_si128(edge, _mm_cmpeq_epi32(n.d, n.b));
+            __m128i bf = _mm_and_si128(edge, _mm_cmpeq_epi32(n.b, n.f));
+            __m128i dh = _mm_and_si128(edge, _mm_cmpeq_epi32(n.d, n.h));
+            __m128i hf = _mm_and_si128(edge, _mm_cmpeq_epi32(n.h, n.f));
+            __m128i ea = _mm_cmpeq_epi32(n.e, n.a), ec = _mm_cmpeq_epi32(n.e, n.c);
+            __m128i eg = _mm_cmpeq_epi32(n.e, n.g), ei = _mm_cmpeq_epi32(n.e, n.i);
+
+            __m128i e0 = upscale_select(db, n.d, n.e);
+            __m128i e1 = upscale_select(_mm_or_si128(_mm_andnot_si128(ec, db), _mm_andnot_si128(ea, bf)), n.b, n.e);
+            __m128i e2 = upscale_select(bf, n.f, n.e);
+            __m128i e3 = upscale_select(_mm_or_si128(_mm_andnot_si128(eg, db), _mm_andnot_si128(ea, dh)), n.d, n.e);
+            __m128i e5 = upscale_select(_mm_or_si128(_mm_andnot_si128(ei, bf), _mm_andnot_si128(ec, hf)), n.f, n.e);
+            __m128i e6 = upscale_select(dh, n.d, n.e);
+            __m128i e7 = upscale_select(_mm_or_si128(_mm_andnot_si128(ei, dh), _mm_andnot_si128(eg, hf)), n.h, n.e);
+            __m128i e8 = upscale_select(hf, n.f, n.e);
+            upscale_store3(&out[x * 3], e0, e1, e2);
+            upscale_store3(&out[pitch + x * 3], e3, n.e, e5);
+            upscale_store3(&out[2 * pitch + x * 3], e6, e7, e8);
+        }
+    }
+}
+
+// One row widened `scale` times; width is a multiple of 4
+static void upscale_row(const uint32_t* src, int width, int scale, uint32_t* out) {
+    if (scale == 1) {
+        memcpy(out, src, width * sizeof(uint32_t));
+        return;
+    }
+    for (int x = 0; x < width; x += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i*)&src[x]);
+        if (scale == 2) {
+            upscale_store2(&out[x * 2], p, p);
+        } else if (scale == 3) {
+            upscale_store3(&out[x * 3], p, p, p);
+        } else if (scale == 4) {
+            upscale_store2(&out[x * 4], _mm_unpacklo_epi32(p, p), _mm_unpacklo_epi32(p, p));
+            upscale_store2(&out[x * 4 + 8], _mm_unpackhi_epi32(p, p), _mm_unpackhi_epi32(p, p));
+        } else {
+            for (int i = 0; i < 4; i++) {
+                uint32_t* run = &out[(x + i) * scale];
+                __m128i pixel = _mm_set1_epi32((int)src[x + i]);
+                int n = 0;
+                for (; n + 4 <= scale; n += 4) _mm_storeu_si128((__m128i*)&run[n], pixel);
+                for (; n < scale; n++) run[n] = src[x + i];
+            }
+        }
+    }
+}
+
+// Half brightness, alpha kept (RGBA8888: alpha is the low byte)
+static void upscale_darken(const uint32_t* src, int width, uint32_t* out) {
+    const __m128i rgb = _mm_set1_epi32(0x7F7F7F00);
+    const __m128i alpha = _mm_set1_epi32(0x000000FF);
+    for (int x = 0; x < width; x += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i*)&src[x]);
+        __m128i half = _mm_and_si128(_mm_srli_epi32(p, 1), rgb);
+        _mm_storeu_si128((__m128i*)&out[x], _mm_or_si128(half, _mm_and_si128(p, alpha)));
+    }
+}
+
+// width x height pixels (width a multiple of 4, at most
+// UPSCALE_MAX_SOURCE_WIDTH x UPSCALE_MAX_SOURCE_HEIGHT) into `dst`, which
+// holds (width * scale) x (height * scale) pixels at `dstPitch` bytes a row.
+// `scale` comes from upscale_fit.
+void upscale_frame(Upscaler* u, const uint32_t* src, int width, int height, int scale, void* dst, int dstPitch) {
+    int factor = upscaleFilters[u->filter].factor;
+    if (scale % factor) factor = 1;  // window too small for the filter
+    const uint32_t* image = src;
+    if (factor > 1) {
+        upscale_pad(u, src, width, height);
+        if (factor == 2) {
+            upscale_scale2x(u, width, height);
+        } else {
+            upscale_scale3x(u, width, height);
+        }
+        image = u->filtered;
+    }
+
+    // Nearest the rest of the way: widen each filtered row once, copy it down
+    int imageWidth = width * factor;
+    int rest = scale / factor;
+    int outWidth = imageWidth * rest;
+    for (int y = 0; y < height * factor; y++) {
+        uint8_t* first = (uint8_t*)dst + (size_t)y * rest * dstPitch;
+        upscale_row(&image[y * imageWidth], imageWidth, rest, (uint32_t*)first);
+        for (int r = rest - 1; r >= 0; r--) {  // the first row last: the others copy it
+            uint32_t* row = (uint32_t*)(first + (size_t)r * dstPitch);
+            bool dark = u->scanlines && scale > 1 && (y * rest + r) % scale == scale - 1;
+            if (dark) {
+                upscale_darken((const uint32_t*)first, outWidth, row);
+            } else if (r) {
+                memcpy(row, first, outWidth * sizeof(uint32_t));
+            }
+        }
+    }
+}
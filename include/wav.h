@@ -0,0 +1,88 @@
+#pragma once
+#include <buzzer.h>
+#include <header.h>
+
+#define WAV_BUFFER_SAMPLES 16384  // samples held before each fwrite
+#define WAV_HEADER_SIZE 44
+
+// === WAV writer ===
+// Streams 16-bit mono PCM through a fixed buffer, so memory stays constant no
+// matter how long the run is. Sizes in the header are patched on close.
+typedef struct {
+    FILE* file;
+    int sampleRate;
+    uint32_t samplesWritten;
+    int buffered;
+    int16_t buffer[WAV_BUFFER_SAMPLES];
+} WavWriter;
+
+static void wav_put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void wav_put32(uint8_t* p, uint32_t v) {
+    wav_put16(p, v & 0xFFFF);
+    wav_put16(p + 2, v >> 16);
+}
+
+static void wav_writeHeader(WavWriter* w) {
+    uint32_t dataBytes = w->samplesWritten * sizeof(int16_t);
+    uint8_t header[WAV_HEADER_SIZE];
+
+    memcpy(header, "RIFF", 4);
+    wav_put32(header + 4, 36 + dataBytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    wav_put32(header + 16, 16);                         // fmt chunk size
+    wav_put16(header + 20, 1);                          // PCM
+    wav_put16(header + 22, 1);                          // mono
+    wav_put32(header + 24, w->sampleRate);              // sample rate
+    wav_put32(header + 28, w->sampleRate * 2);          // byte rate
+    wav_put16(header + 32, 2);                          // block align
+    wav_put16(header + 34, 16);                         // bits per sample
+    memcpy(header + 36, "data", 4);
+    wav_put32(header + 40, dataBytes);
+
+    fseek(w->file, 0, SEEK_SET);
+    fwrite(header, 1, WAV_HEADER_SIZE, w->file);
+}
+
+bool wav_open(WavWriter* w, const char* filename, int sampleRate) {
+    w->file = fopen(filename, "wb");
+    if (!w->file) {
+        perror("Failed to open WAV file");
+        return false;
+    }
+    w->sampleRate = sampleRate;
+    w->samplesWritten = 0;
+    w->buffered = 0;
+    wav_writeHeader(w);  // placeholder, rewritten with the real sizes on close
+    return true;
+}
+
+void wav_flush(WavWriter* w) {
+    fwrite(w->buffer, sizeof(int16_t), w->buffered, w->file);  // PCM is little-endian like x86
+    w->samplesWritten += w->buffered;
+    w->buffered = 0;
+}
+
+// Render `count` buzzer samples straight into the write buffer
+void wav_writeBuzzer(WavWriter* w, Buzzer* b, int count, bool on) {
+    while (count > 0) {
+        if (w->buffered == WAV_BUFFER_SAMPLES) wav_flush(w);
+
+        int chunk = WAV_BUFFER_SAMPLES - w->buffered;
+        if (chunk > count) chunk = count;
+        buzzer_render(b, &w->buffer[w->buffered], chunk, on);
+        w->buffered += chunk;
+        count -= chunk;
+    }
+}
+
+void wav_close(WavWriter* w) {
+    if (!w->file) return;
+    wav_flush(w);
+    wav_writeHeader(w);
+    fclose(w->file);
+    w->file = NULL;
+}
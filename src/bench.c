@@ -0,0 +1,252 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+
+// Benchmark for the emulator core: every ROM in roms/ plus synthetic workloads,
+// each run through chip8Cycle for a fixed instruction count, several times.
+//
+//   bench [--instructions N] [--repeats N] [--json bench.json]
+//
+// Each synthetic workload is a straight line of one opcode class followed by a
+// jump back, so its ns/instruction is the cost of that class.
+
+#define STR(x) #x
+#define XSTR(x) STR(x)
+#ifdef BUILD_REVISION
+#define BENCH_REVISION XSTR(BUILD_REVISION)
+#else
+#define BENCH_REVISION "unknown"
+#endif
+#ifdef BUILD_FLAGS
+#define BENCH_FLAGS XSTR(BUILD_FLAGS)
+#else
+#define BENCH_FLAGS "unknown"
+#endif
+
+#define MAX_WORKLOADS 64
+#define MAX_REPEATS 32
+#define BODY_START 0x210
+#define BODY_INSTRUCTIONS 1024
+#define OP_CALL_RET 0x2FFF  // placeholder: CALL the RET placed after the body
+#define OP_JP_NEXT 0x1FFF   // placeholder: JP to the following instruction
+#define STALL_FRAMES 600    // frames in a row without an instruction before a run is given up
+
+typedef struct {
+    const char* name;
+    uint16_t setup[4];
+    uint16_t body[6];
+} Synthetic;
+
+static const Synthetic synthetics[] = {
+    {"load_add", {0}, {0x6012, 0x7103}},
+    {"alu", {0}, {0x8014, 0x8125, 0x8206, 0x830E, 0x8411, 0x8532}},
+    {"skip", {0x6000, 0x6100}, {0x3001, 0x4000, 0x9010}},  // none taken
+    {"jump", {0}, {OP_JP_NEXT}},
+    {"call_ret", {0}, {OP_CALL_RET}},
+    {"index", {0}, {0xA300, 0xF01E, 0xF029}},
+    {"random", {0}, {0xC0FF}},
+    {"timers", {0}, {0xF015, 0xF007, 0xF018}},
+    {"memory", {0xAE00}, {0xFF55, 0xFF65, 0xF033}},  // I well clear of the code
+    {"draw", {0xA050, 0x6000, 0x6100}, {0xD015}},
+};
+
+typedef struct {
+    char name[64];
+    bool synthetic;
+    uint8_t rom[MEM_SIZE - 0x200];
+    size_t romSize;
+    double ips[MAX_REPEATS];  // instructions per second, per run
+    double mean, stddev, minimum, maximum;
+    const char* failure;  // why a run stopped short, NULL if all of them finished
+} Workload;
+
+static Workload workloads[MAX_WORKLOADS];
+static int workloadCount = 0;
+
+void putOpcode(Workload* w, uint16_t address, uint16_t opcode) {
+    w->rom[address - 0x200] = opcode >> 8;
+    w->rom[address - 0x200 + 1] = opcode & 0xFF;
+}
+
+void buildSynthetic(Workload* w, const Synthetic* s) {
+    snprintf(w->name, sizeof(w->name), "%s", s->name);
+    w->synthetic = true;
+    memset(w->rom, 0, sizeof(w->rom));
+
+    uint16_t address = 0x200;
+    for (int i = 0; i < 4 && s->setup[i]; i++, address += 2) putOpcode(w, address, s->setup[i]);
+    putOpcode(w, address, 0x1000 | BODY_START);  // skip any padding up to the body
+
+    int bodyLength = 0;
+    while (bodyLength < 6 && s->body[bodyLength]) bodyLength++;
+
+    uint16_t loopEnd = BODY_START + BODY_INSTRUCTIONS * 2;
+    uint16_t retAddress = loopEnd + 2;
+    for (int i = 0; i < BODY_INSTRUCTIONS; i++) {
+        uint16_t pc = BODY_START + i * 2;
+        uint16_t opcode = s->body[i % bodyLength];
+        if (opcode == OP_CALL_RET) opcode = 0x2000 | retAddress;
+        if (opcode == OP_JP_NEXT) opcode = 0x1000 | (pc + 2);
+        putOpcode(w, pc, opcode);
+    }
+    putOpcode(w, loopEnd, 0x1000 | BODY_START);
+    putOpcode(w, retAddress, 0x00EE);
+    w->romSize = retAddress + 2 - 0x200;
+}
+
+bool addRom(const char* filename) {
+    Workload* w = &workloads[workloadCount];
+    FILE* rom = fopen(filename, "rb");
+    if (!rom) {
+        perror("Failed to open ROM");
+        return false;
+    }
+    w->romSize = fread(w->rom, 1, sizeof(w->rom), rom);
+    fclose(rom);
+
+    snprintf(w->name, sizeof(w->name), "%s", filename);
+    w->synthetic = false;
+    workloadCount++;
+    return true;
+}
+
+int compareNames(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// One timed run of `instructions` instructions, in instructions per second.
+// A ROM that faults, or stops executing for STALL_FRAMES frames, ends the run
+// early and sets w->failure.
+double runWorkload(Workload* w, uint64_t instructions) {
+    static Chip8 chip8;
+    chip8_init(&chip8);
+    chip8_loadBuffer(&chip8, w->rom, w->romSize);
+
+    uint64_t executed = 0;
+    int slotAccumulator = 0;
+    int idleFrames = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+    while (executed < instructions) {
+        int ran = chip8_runFrame(&chip8, &slotAccumulator);
+        if (chip8.waitingForKey) {
+            // Nobody is at the keypad: tap key 1 so FX0A menus keep moving
+            chip8.keys = 1u << 1;
+            chip8_resolveKeyWait(&chip8);
+            chip8.keys = 0;
+        }
+        executed += ran;
+        if (chip8.fault != CHIP8_FAULT_NONE) {
+            w->failure = chip8FaultNames[chip8.fault];
+            break;
+        }
+        idleFrames = ran ? 0 : idleFrames + 1;
+        if (idleFrames == STALL_FRAMES) {
+            w->failure = "stalled (no instructions executed)";
+            break;
+        }
+    }
+    uint64_t ticks = SDL_GetPerformanceCounter() - start;
+    return executed * (double)SDL_GetPerformanceFrequency() / (double)ticks;
+}
+
+void summarize(Workload* w, int repeats) {
+    w->mean = 0;
+    w->minimum = w->maximum = w->ips[0];
+    for (int r = 0; r < repeats; r++) {
+        w->mean += w->ips[r];
+        if (w->ips[r] < w->minimum) w->minimum = w->ips[r];
+        if (w->ips[r] > w->maximum) w->maximum = w->ips[r];
+    }
+    w->mean /= repeats;
+
+    double variance = 0;
+    for (int r = 0; r < repeats; r++) variance += (w->ips[r] - w->mean) * (w->ips[r] - w->mean);
+    w->stddev = repeats > 1 ? SDL_sqrt(variance / (repeats - 1)) : 0;
+}
+
+void writeJson(FILE* out, uint64_t instructions, int repeats) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"revision\": \"%s\",\n", BENCH_REVISION);
+    fprintf(out, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(out, "  \"flags\": \"%s\",\n", BENCH_FLAGS);
+    fprintf(out, "  \"instructions\": %llu,\n", (unsigned long long)instructions);
+    fprintf(out, "  \"repeats\": %d,\n", repeats);
+    fprintf(out, "  \"workloads\": [\n");
+    for (int i = 0; i < workloadCount; i++) {
+        Workload* w = &workloads[i];
+        const char* separator = i + 1 < workloadCount ? "," : "";
+        if (w->failure) {
+            fprintf(out, "    {\"name\": \"%s\", \"kind\": \"%s\", \"failed\": \"%s\"}%s\n", w->name,
+                    w->synthetic ? "opcode_class" : "rom", w->failure, separator);
+            continue;
+        }
+        fprintf(out,
+                "    {\"name\": \"%s\", \"kind\": \"%s\", \"ips_mean\": %.0f, \"ips_stddev\": %.0f, "
+                "\"ips_min\": %.0f, \"ips_max\": %.0f, \"ns_per_instruction\": %.3f, \"cv_percent\": %.2f}%s\n",
+                w->name,
+                w->synthetic ? "opcode_class" : "rom",
+                w->mean,
+                w->stddev,
+                w->minimum,
+                w->maximum,
+                1e9 / w->mean,
+                100.0 * w->stddev / w->mean,
+                separator);
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t instructions = 2000000;
+    int repeats = 5;
+    const char* jsonFile = "bench.json";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--instructions") == 0) {
+            instructions = strtoull(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "--repeats") == 0) {
+            repeats = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--json") == 0) {
+            jsonFile = argv[i + 1];
+        }
+    }
+    if (repeats < 1) repeats = 1;
+    if (repeats > MAX_REPEATS) repeats = MAX_REPEATS;
+
+    int romCount = 0;
+    char** roms = SDL_GlobDirectory("roms", "*.ch8", 0, &romCount);
+    if (roms) {
+        qsort(roms, romCount, sizeof(roms[0]), compareNames);
+        for (int i = 0; i < romCount && workloadCount < MAX_WORKLOADS; i++) {
+            char path[96];
+            snprintf(path, sizeof(path), "roms/%s", roms[i]);
+            addRom(path);
+        }
+        SDL_free(roms);
+    }
+    for (size_t i = 0; i < SDL_arraysize(synthetics) && workloadCount < MAX_WORKLOADS; i++) {
+        buildSynthetic(&workloads[workloadCount++], &synthetics[i]);
+    }
+
+    printf("%-24s %14s %10s %8s\n", "workload", "instr/sec", "ns/instr", "cv %");
+    for (int i = 0; i < workloadCount; i++) {
+        Workload* w = &workloads[i];
+        for (int r = 0; r < repeats && !w->failure; r++) w->ips[r] = runWorkload(w, instructions);
+        if (w->failure) {
+            printf("%-24s FAILED: %s\n", w->name, w->failure);
+            continue;
+        }
+        summarize(w, repeats);
+        printf("%-24s %14.0f %10.3f %8.2f\n", w->name, w->mean, 1e9 / w->mean, 100.0 * w->stddev / w->mean);
+    }
+
+    FILE* out = fopen(jsonFile, "w");
+    if (!out) {
+        perror("Failed to write benchmark JSON");
+        return 1;
+    }
+    writeJson(out, instructions, repeats);
+    fclose(out);
+    printf("wrote %s (revision %s)\n", jsonFile, BENCH_REVISION);
+    return 0;
+}
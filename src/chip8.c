@@ -1,46 +1,248 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
+#include <audio.h>
 #include <chip8.h>
+#include <debugger.h>
+#include <frameshare.h>
+#include <gdbstub.h>
 #include <platform.h>
 #include <testRom.h>
 
-#define CHIP8_HZ 500  // 500 Hz = 2 ms per cycle
-#define CYCLE_DELAY (1000 / CHIP8_HZ)
+#define FRAME_NS (SDL_NS_PER_SECOND / TIMER_HZ)
 const char* filename = "roms/4-flags.ch8";
 
+// Options:
+//   --run-ahead N          show the frame N frames ahead of the input (0-4), hiding N frames of latency
+//   --upscale FILTER       scale on the CPU into a 1:1 texture: nearest, scale2x or scale3x
+//   --scanlines            darken the last row of each upscaled pixel row (with --upscale)
+//   --publish SLOT         copy every frame into slot SLOT of the shared frame segment (frameshare.h)
+//   --trace FILE           binary instruction trace for tracedump (make TRACE=1 builds)
+//
+// Debugger options (addresses in hex):
+//   --break 2A4            breakpoint
+//   --watch 300[+N]        memory read/write watchpoint (also --watch-read, --watch-write)
+//   --watch-index          any access to I
+//   --watch-v F            any access to VF
+//   --gdb 1234             GDB remote stub on 127.0.0.1:1234 (decimal port)
+// F5 pauses/continues, F10 steps one instruction, F9 toggles a breakpoint at PC.
+static uint16_t gdbPort = 0;
+static int runAhead = 0;
+static int publishSlot = -1;
+static const char* traceFile = NULL;
+static int upscaleFilter = -1;  // -1: the renderer stretches the texture
+static bool scanlines = false;
+
+#define RUN_AHEAD_MAX 4
+
+// Draw the frame: chip8_render for the renderer to stretch, or the native
+// resolution for the CPU upscaler
+static void present(Platform* platform, const Chip8* chip8, uint32_t* frame) {
+    if (platform->upscaler) {
+        chip8_renderNative(chip8, frame);
+        platform_updateScaled(platform, frame, chip8_displayWidth(chip8), chip8_displayHeight(chip8));
+    } else {
+        chip8_render(chip8, frame);
+        platform_update(platform, frame, sizeof(frame[0]) * HIRES_WIDTH);
+    }
+}
+
+// One 60 Hz frame of emulated time. Normally that is chip8_runFrame; with a
+// breakpoint or watchpoint set, the frame's slots go one at a time so the
+// debugger sees each instruction before it runs. A stop or a fault pauses
+// the debugger and ends the frame's instructions early.
+static void runFrame(Chip8* chip8, Debugger* debugger, int* slotAccumulator) {
+    chip8->fault = CHIP8_FAULT_NONE;  // an earlier one was reported when it happened
+    if (!debugger->armed) {
+        chip8_runFrame(chip8, slotAccumulator);
+    } else {
+        *slotAccumulator += chip8->hz;
+        int slots = *slotAccumulator / TIMER_HZ;
+        *slotAccumulator %= TIMER_HZ;
+        for (int slot = 0; slot < slots && chip8->fault == CHIP8_FAULT_NONE; slot++) {
+            // FX0A and display waits are not stops
+            bool waiting = chip8->waitingForKey || chip8->waitingForVblank;
+            if (!waiting && debugger_check(debugger, chip8)) {
+                debugger_print(debugger, chip8, stdout);
+                break;
+            }
+            chip8_runCycles(chip8, 1);
+        }
+        chip8_tickTimers(chip8);
+    }
+    if (chip8->fault != CHIP8_FAULT_NONE) {
+        debugger_fault(debugger, chip8);  // pause on it instead of taking the window down
+        debugger_print(debugger, chip8, stdout);
+    }
+}
+
+static void parseDebugOptions(Debugger* debugger, int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(option, "--watch-index") == 0) {
+            debugger_watchIndex(debugger, DEBUG_READ | DEBUG_WRITE);
+        } else if (strcmp(option, "--scanlines") == 0) {
+            scanlines = true;
+        } else if (value && strcmp(option, "--upscale") == 0) {
+            upscaleFilter = upscale_filterByName(value);
+            if (upscaleFilter < 0) fprintf(stderr, "unknown filter %s, the renderer scales\n", value);
+            i++;
+        } else if (value && strcmp(option, "--break") == 0) {
+            debugger_toggleBreakpoint(debugger, (uint16_t)strtol(value, NULL, 16));
+            i++;
+        } else if (value && strcmp(option, "--run-ahead") == 0) {
+            runAhead = SDL_clamp(atoi(value), 0, RUN_AHEAD_MAX);
+            i++;
+        } else if (value && strcmp(option, "--trace") == 0) {
+            traceFile = value;
+            i++;
+        } else if (value && strcmp(option, "--publish") == 0) {
+            publishSlot = atoi(value);
+            i++;
+        } else if (value && strcmp(option, "--gdb") == 0) {
+            gdbPort = (uint16_t)strtol(value, NULL, 10);
+            i++;
+        } else if (value && strcmp(option, "--watch-v") == 0) {
+            debugger_watchRegister(debugger, (uint8_t)strtol(value, NULL, 16), DEBUG_READ | DEBUG_WRITE);
+            i++;
+        } else if (value && strncmp(option, "--watch", 7) == 0) {
+            uint8_t access = DEBUG_READ | DEBUG_WRITE;
+            if (strcmp(option, "--watch-read") == 0) access = DEBUG_READ;
+            if (strcmp(option, "--watch-write") == 0) access = DEBUG_WRITE;
+
+            char* end;
+            uint16_t address = (uint16_t)strtol(value, &end, 16);
+            uint16_t length = (*end == '+') ? (uint16_t)strtol(end + 1, NULL, 16) : 1;
+            debugger_watchMemory(debugger, address, length, access);
+            i++;
+        } else {
+            filename = option;
+        }
+    }
+}
+
 int main(int argc, char** argv) {
-    (void)argc;
-    (void)argv;
+    Debugger debugger;
+    debugger_init(&debugger);
+    parseDebugOptions(&debugger, argc, argv);
+
+    GdbStub gdb;
+    gdb.listener = gdb.client = INVALID_SOCKET;
+    if (gdbPort && !gdbstub_open(&gdb, gdbPort)) gdbPort = 0;  // runs without the stub, nothing to close
+
+    FrameShare share = {0};
+    if (publishSlot >= 0) frameshare_open(&share, FRAMESHARE_NAME, publishSlot);  // runs without it on failure
 
     Platform platform;
     platform_init(&platform,
                   "CHIP-8 Emulator",
                   DISPLAY_WIDTH * 10,
                   DISPLAY_HEIGHT * 10,
-                  DISPLAY_WIDTH,
-                  DISPLAY_HEIGHT);
+                  HIRES_WIDTH,
+                  HIRES_HEIGHT);
+    if (upscaleFilter >= 0) platform_enableUpscale(&platform, (UpscaleFilter)upscaleFilter, scanlines);
+
+    Audio audio;
+    audio_init(&audio);
 
     Chip8 chip8;
     chip8_init(&chip8);
-    romLoaderNoMaloc(&chip8, filename);
+    chip8_loadFile(&chip8, filename);
+#ifdef CHIP8_TRACE
+    static TraceLog trace;
+    if (traceFile && trace_open(&trace, traceFile)) chip8.trace = &trace;
+#else
+    if (traceFile) fprintf(stderr, "tracing needs a TRACE=1 build\n");
+#endif
 
-    uint32_t lastCycleTime = SDL_GetTicks();  // milliseconds
+    uint64_t lastFrameTime = SDL_GetTicksNS();
+    int slotAccumulator = 0;  // remainder of chip8.hz / TIMER_HZ per frame
+    int frameCount = 0;
     bool quit = false;
-    int videoPitch = sizeof(chip8.display[0]) * DISPLAY_WIDTH;
+    static uint32_t frame[HIRES_WIDTH * HIRES_HEIGHT];  // present(): chip8_render output, or native pixels to upscale
+    static Chip8State ahead;  // run-ahead scratch copy, presented instead of chip8
+    uint64_t runAheadNs = 0;  // spent running ahead since the last readout
 
     while (!quit) {
-        quit = platform_processInput(chip8.keypad);
+        if (!debugger.paused) {
+            // Everything happens once a frame: sleep until SDL has an event or the next frame is due
+            uint64_t sinceFrame = SDL_GetTicksNS() - lastFrameTime;
+            if (sinceFrame < FRAME_NS) {
+                SDL_WaitEventTimeout(NULL, (Sint32)SDL_NS_TO_MS(FRAME_NS - sinceFrame) + 1);
+            }
+        }
+        PlatformControl control;
+        quit = platform_processInput(&chip8.input, chip8.clock, &control);
 
-        uint32_t currentTime = SDL_GetTicks();
-        uint32_t dt = currentTime - lastCycleTime;
+        if (control == PLATFORM_CONTROL_PAUSE) {
+            if (debugger.paused) {
+                debugger_continue(&debugger, &chip8);
+            } else {
+                debugger.paused = true;
+                debugger_print(&debugger, &chip8, stdout);
+            }
+        } else if (control == PLATFORM_CONTROL_STEP && debugger.paused) {
+            if (chip8Cycle(&chip8) != CHIP8_FAULT_NONE) {
+                debugger_fault(&debugger, &chip8);
+            } else {
+                debugger.stop = DEBUG_STOP_NONE;
+            }
+            present(&platform, &chip8, frame);
+            debugger_print(&debugger, &chip8, stdout);
+        } else if (control == PLATFORM_CONTROL_BREAKPOINT) {
+            bool on = debugger_toggleBreakpoint(&debugger, chip8.pc);
+            printf("breakpoint at %03X %s\n", chip8.pc, on ? "set" : "cleared");
+        }
+
+        if (debugger.paused) {
+            // Time stands still while paused: no timers, no tone
+            lastFrameTime = SDL_GetTicksNS();
+            audio_update(&audio, false);
+            if (gdbstub_attached(&gdb)) {
+                gdbstub_poll(&gdb, &chip8, &debugger);  // GDB is in charge: keep answering packets
+                SDL_WaitEventTimeout(NULL, 1);
+            } else {
+                SDL_WaitEventTimeout(NULL, (Sint32)SDL_NS_TO_MS(FRAME_NS));
+            }
+        }
 
-        if (dt > CYCLE_DELAY) {  // count to 2ms
-            lastCycleTime = currentTime;
-            chip8Cycle(&chip8);
+        // 60 Hz frame: chip8.hz / 60 instructions and the timer tick, then top up
+        // the audio stream from the new sound timer
+        if (SDL_GetTicksNS() - lastFrameTime >= FRAME_NS) {
+            lastFrameTime += FRAME_NS;
+            if (!debugger.paused) runFrame(&chip8, &debugger, &slotAccumulator);
+            if (!runAhead) present(&platform, &chip8, frame);
+            buzzer_setPattern(&audio.buzzer, chip8.hasAudioPattern ? chip8.audioPattern : NULL, chip8.pitch);
+            audio_update(&audio, chip8.sound_timer > 0);
+            gdbstub_poll(&gdb, &chip8, &debugger);  // accept / Ctrl-C / stop reply, once a frame
+            if (share.slot) frameshare_publish(&share, &chip8);
 
-            platform_update(&platform, chip8.display, videoPitch);
+            if (runAhead && !debugger.paused) {
+                // Present the frame the current keys lead to runAhead frames from now
+                uint64_t start = SDL_GetTicksNS();
+                chip8_runAhead(&chip8, &ahead, runAhead);
+                runAheadNs += SDL_GetTicksNS() - start;
+                present(&platform, &ahead, frame);
+            }
+
+            if (++frameCount % TIMER_HZ == 0) {  // debug readout, once a second
+                char title[96];
+                SDL_snprintf(title, sizeof(title), "CHIP-8 Emulator | audio queue %.1f ms | run-ahead %d: %.2f ms",
+                             audio_queuedMs(&audio), runAhead, runAheadNs / 1e6 / TIMER_HZ);
+                SDL_SetWindowTitle(platform.window, title);
+                runAheadNs = 0;
+            }
         }
     }
+
+    if (gdbPort) gdbstub_close(&gdb);
+    frameshare_close(&share);
+#ifdef CHIP8_TRACE
+    if (chip8.trace) trace_close(&trace);
+#endif
+    audio_destroy(&audio);
+    platform_destroy(&platform);
     return 0;
 }
 
@@ -51,7 +253,6 @@ int main(int argc, char** argv) {
 // A 0 B F      Z X C V
 
 // FOR TESTING
-// romLoaderTest(&chip8, testRomStage1, sizeof(testRomStage1));
+// chip8_loadBuffer(&chip8, testRomStage1, sizeof(testRomStage1));
 // debug_dump_memory(chip8.memory, 0x200, 32);
-// debug_dump_memory(chip8.memory, 0x200, getRomSize(filename));
-
+// debug_dump_memory(chip8.memory, 0x200, chip8_loadFile(&chip8, filename));
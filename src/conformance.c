@@ -0,0 +1,282 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+
+// Conformance suite: runs every ROM listed in the golden manifest for a fixed
+// number of frames (all ROMs in parallel, one thread each), hashes the final
+// display + registers and compares against the manifest.
+//
+//   conformance [--update] [manifest]
+//
+// Manifest entries (blank lines and # comments are ignored):
+//   rom <file in roms/> <frames> [profile=NAME] [hz=N] [key@frame ...]   key is hex, held for KEY_HOLD_FRAMES
+//     (without profile= the ROM database picks the quirks, as on a normal load; without hz= the
+//     profile's rate applies)
+//   hash <64-bit FNV-1a, hex>
+//   regs <register summary>
+//   <dumpDisplay output: 32 lines of 64, or 64 of 128 in SUPER-CHIP hires>
+// --update rewrites the hash/regs/display lines from the current emulator.
+
+#define GOLDEN_FILE "roms/golden.txt"
+#define MAX_ENTRIES 64
+#define MAX_KEYS 8
+#define KEY_HOLD_FRAMES 6
+#define REGS_LENGTH 160
+
+typedef struct {
+    uint8_t key;
+    int frame;
+} KeyPress;
+
+typedef struct {
+    char rom[64];
+    int frames;
+    int profile;  // Chip8Profile, or -1 for the ROM database's
+    int hz;       // instructions per second, 0 for the profile's
+    KeyPress keys[MAX_KEYS];
+    int keyCount;
+
+    // golden
+    bool hasGolden;
+    uint64_t hash;
+    char regs[REGS_LENGTH];
+    char display[HIRES_HEIGHT][HIRES_WIDTH + 1];
+    int displayRows;
+
+    // result
+    bool loaded;
+    Chip8 chip8;
+    uint64_t actualHash;
+    char actualRegs[REGS_LENGTH];
+} Entry;
+
+static Entry entries[MAX_ENTRIES];
+static int entryCount = 0;
+
+// Bounded copy of a manifest field (truncates long lines)
+void copyField(char* dst, size_t size, const char* src) {
+    size_t length = strlen(src);
+    if (length >= size) length = size - 1;
+    memcpy(dst, src, length);
+    dst[length] = '\0';
+}
+
+uint64_t hashState(const Chip8* chip8) {
+    uint64_t hash = 0xCBF29CE484222325ull;  // FNV-1a
+#define HASH_BYTE(b)               \
+    do {                           \
+        hash ^= (uint8_t)(b);      \
+        hash *= 0x100000001B3ull;  \
+    } while (0)
+
+    for (int y = 0; y < chip8_displayHeight(chip8); y++) {
+        for (int x = 0; x < chip8_displayWidth(chip8); x++) HASH_BYTE(chip8_pixel(chip8, x, y));
+    }
+    for (int i = 0; i < 16; i++) HASH_BYTE(chip8->V[i]);
+    for (int i = 0; i < STACK_SIZE; i++) {
+        HASH_BYTE(chip8->stack[i]);
+        HASH_BYTE(chip8->stack[i] >> 8);
+    }
+    HASH_BYTE(chip8->index);
+    HASH_BYTE(chip8->index >> 8);
+    HASH_BYTE(chip8->pc);
+    HASH_BYTE(chip8->pc >> 8);
+    HASH_BYTE(chip8->sp);
+    HASH_BYTE(chip8->delay_timer);
+    HASH_BYTE(chip8->sound_timer);
+#undef HASH_BYTE
+    return hash;
+}
+
+void formatRegs(const Chip8* chip8, char* out) {
+    int n = snprintf(out, REGS_LENGTH, "pc=%03X i=%03X sp=%X dt=%02X st=%02X v=",
+                     chip8->pc, chip8->index, chip8->sp, chip8->delay_timer, chip8->sound_timer);
+    for (int i = 0; i < 16; i++) {
+        n += snprintf(out + n, REGS_LENGTH - n, "%02X", chip8->V[i]);
+    }
+}
+
+// One character per pixel colour, as in dumpDisplay: plane 0 only is '#',
+// plane 1 only 'o', both '@'
+static const char displayChars[] = ".#o@";
+
+static uint8_t displayColour(char c) {
+    const char* found = c ? strchr(displayChars, c) : NULL;
+    return found ? (uint8_t)(found - displayChars) : 0;
+}
+
+// Same picture as dumpDisplay, with mismatches marked: + lit but should be a
+// different colour, - dark but should be lit
+void printDisplayDiff(const Entry* e) {
+    for (int y = 0; y < chip8_displayHeight(&e->chip8); y++) {
+        printf("    ");
+        for (int x = 0; x < chip8_displayWidth(&e->chip8); x++) {
+            uint8_t actual = chip8_pixel(&e->chip8, x, y);
+            uint8_t expected = y < e->displayRows ? displayColour(e->display[y][x]) : 0;
+            putchar(actual == expected ? displayChars[actual] : (actual ? '+' : '-'));
+        }
+        putchar('\n');
+    }
+}
+
+int runEntry(void* data) {
+    Entry* e = data;
+    chip8_init(&e->chip8);
+
+    char path[96];
+    snprintf(path, sizeof(path), "roms/%s", e->rom);
+    e->loaded = chip8_loadFile(&e->chip8, path) >= 0;
+    if (!e->loaded) return 0;
+    if (e->profile >= 0 || e->hz) {
+        chip8_setProfile(&e->chip8, e->profile >= 0 ? (Chip8Profile)e->profile : e->chip8.profile, e->hz);
+    }
+
+    int slotAccumulator = 0;
+    for (int frame = 0; frame < e->frames; frame++) {
+        for (int k = 0; k < e->keyCount; k++) {
+            if (frame == e->keys[k].frame) chip8_queueKey(&e->chip8, e->chip8.clock, e->keys[k].key, true);
+            if (frame == e->keys[k].frame + KEY_HOLD_FRAMES) {
+                chip8_queueKey(&e->chip8, e->chip8.clock, e->keys[k].key, false);
+            }
+        }
+        chip8_runFrame(&e->chip8, &slotAccumulator);
+    }
+
+    e->actualHash = hashState(&e->chip8);
+    formatRegs(&e->chip8, e->actualRegs);
+    return 0;
+}
+
+bool loadManifest(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        perror("Failed to open golden manifest");
+        return false;
+    }
+
+    char line[256];
+    Entry* e = NULL;
+    bool inDisplay = false;
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        inDisplay = inDisplay && line[0] && strchr(displayChars, line[0]) && e->displayRows < HIRES_HEIGHT;
+        if (inDisplay) {
+            copyField(e->display[e->displayRows++], HIRES_WIDTH + 1, line);
+            continue;
+        }
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        if (strncmp(line, "rom ", 4) == 0) {
+            if (entryCount == MAX_ENTRIES) break;
+            e = &entries[entryCount++];
+            memset(e, 0, sizeof(*e));
+
+            char* token = strtok(line + 4, " ");
+            copyField(e->rom, sizeof(e->rom), token ? token : "");
+            token = strtok(NULL, " ");
+            e->frames = token ? atoi(token) : 0;
+            e->profile = -1;
+            while ((token = strtok(NULL, " ")) && e->keyCount < MAX_KEYS) {
+                unsigned key;
+                int frame;
+                if (strncmp(token, "profile=", 8) == 0) {
+                    e->profile = chip8_profileByName(token + 8);
+                    if (e->profile < 0) fprintf(stderr, "%s: unknown profile %s\n", e->rom, token + 8);
+                } else if (strncmp(token, "hz=", 3) == 0) {
+                    e->hz = SDL_clamp(atoi(token + 3), 0, UINT16_MAX);
+                } else if (sscanf(token, "%x@%d", &key, &frame) == 2 && key < KEYPAD_SIZE) {
+                    e->keys[e->keyCount++] = (KeyPress){(uint8_t)key, frame};
+                }
+            }
+        } else if (e && strncmp(line, "hash ", 5) == 0) {
+            e->hash = strtoull(line + 5, NULL, 16);
+            e->hasGolden = true;
+        } else if (e && strncmp(line, "regs ", 5) == 0) {
+            copyField(e->regs, REGS_LENGTH, line + 5);
+            inDisplay = true;  // the display follows the registers
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool writeManifest(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        perror("Failed to write golden manifest");
+        return false;
+    }
+
+    fprintf(file, "# Golden results for bin/conformance.exe (regenerate with --update)\n");
+    for (int i = 0; i < entryCount; i++) {
+        Entry* e = &entries[i];
+        fprintf(file, "\nrom %s %d", e->rom, e->frames);
+        if (e->profile >= 0) fprintf(file, " profile=%s", chip8Profiles[e->profile].name);
+        if (e->hz) fprintf(file, " hz=%d", e->hz);
+        for (int k = 0; k < e->keyCount; k++) {
+            fprintf(file, " %X@%d", e->keys[k].key, e->keys[k].frame);
+        }
+        fprintf(file, "\nhash %016llx\nregs %s\n", (unsigned long long)e->actualHash, e->actualRegs);
+        for (int y = 0; y < chip8_displayHeight(&e->chip8); y++) {
+            for (int x = 0; x < chip8_displayWidth(&e->chip8); x++) {
+                fputc(displayChars[chip8_pixel(&e->chip8, x, y)], file);
+            }
+            fputc('\n', file);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* manifest = GOLDEN_FILE;
+    bool update = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else {
+            manifest = argv[i];
+        }
+    }
+
+    if (!loadManifest(manifest)) return 1;
+
+    uint64_t start = SDL_GetTicksNS();
+    SDL_Thread* threads[MAX_ENTRIES];
+    for (int i = 0; i < entryCount; i++) {
+        threads[i] = SDL_CreateThread(runEntry, entries[i].rom, &entries[i]);
+        if (!threads[i]) runEntry(&entries[i]);  // no thread: run it here instead
+    }
+    for (int i = 0; i < entryCount; i++) {
+        if (threads[i]) SDL_WaitThread(threads[i], NULL);
+    }
+    double ms = (SDL_GetTicksNS() - start) / 1e6;
+
+    int passed = 0;
+    for (int i = 0; i < entryCount; i++) {
+        Entry* e = &entries[i];
+        if (!e->loaded) {
+            printf("FAIL %s: could not load ROM\n", e->rom);
+        } else if (update || (e->hasGolden && e->hash == e->actualHash)) {
+            printf("PASS %s (%d frames)\n", e->rom, e->frames);
+            passed++;
+        } else if (!e->hasGolden) {
+            printf("FAIL %s: no golden result, run with --update\n", e->rom);
+        } else {
+            printf("FAIL %s: hash %016llx, expected %016llx\n",
+                   e->rom, (unsigned long long)e->actualHash, (unsigned long long)e->hash);
+            printf("  regs expected %s\n  regs actual   %s\n", e->regs, e->actualRegs);
+            if (e->chip8.fault) printf("  fault at %03X: %s\n", e->chip8.faultPc, chip8FaultNames[e->chip8.fault]);
+            printf("  display (+ extra pixel, - missing pixel):\n");
+            printDisplayDiff(e);
+        }
+    }
+
+    if (update && !writeManifest(manifest)) return 1;
+
+    printf("%d/%d passed in %.2f ms\n", passed, entryCount, ms);
+    return passed == entryCount ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+#include <disasm.h>
+
+// Static disassembler: whole-ROM listing or control-flow graph, without
+// running anything.
+//
+//   disasm [--dot] [--out DIR] [--quiet] <rom.ch8>...
+//
+// Output goes to stdout, or to DIR/<rom>.asm (DIR/<rom>.dot with --dot) per ROM.
+// --quiet only analyses, for timing large ROM sets. A throughput summary is
+// printed to stderr either way; render a graph with `dot -Tsvg rom.dot`.
+
+static const char* baseName(const char* path) {
+    const char* name = path;
+    for (const char* c = path; *c; c++) {
+        if (*c == '/' || *c == '\\') name = c + 1;
+    }
+    return name;
+}
+
+int main(int argc, char** argv) {
+    bool dot = false;
+    bool quiet = false;
+    const char* outDir = NULL;
+    int romCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dot") == 0) {
+            dot = true;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        } else {
+            argv[++romCount] = argv[i];  // compact the ROM paths to argv[1..romCount]
+        }
+    }
+    if (romCount == 0) {
+        fprintf(stderr, "usage: %s [--dot] [--out DIR] [--quiet] <rom.ch8>...\n", argv[0]);
+        return 1;
+    }
+
+    static uint8_t memory[MEM_SIZE];
+    static Disasm disasm;
+    uint64_t analyseNs = 0;
+    uint64_t instructions = 0, blocks = 0;
+    int failed = 0;
+    opcodes_init();  // build the decode table outside the timed region
+
+    for (int r = 1; r <= romCount; r++) {
+        const char* romFile = argv[r];
+        RomMapping rom;
+        if (!rom_map(&rom, romFile)) {
+            failed++;
+            continue;
+        }
+        size_t romSize = rom.size < ROM_MAX_SIZE ? rom.size : ROM_MAX_SIZE;  // past 64 KB is unreachable
+        memset(memory, 0, sizeof(memory));
+        if (romSize) memcpy(&memory[DISASM_START], rom.data, romSize);
+        rom_unmap(&rom);
+
+        uint64_t start = SDL_GetTicksNS();
+        disasm_analyze(&disasm, memory, DISASM_START + romSize);
+        analyseNs += SDL_GetTicksNS() - start;
+        instructions += disasm.instructions;
+        blocks += disasm.blocks;
+
+        if (quiet) continue;
+
+        FILE* out = stdout;
+        if (outDir) {
+            char path[1024];
+            snprintf(path, sizeof(path), "%s/%s.%s", outDir, baseName(romFile), dot ? "dot" : "asm");
+            out = fopen(path, "w");
+            if (!out) {
+                perror(path);
+                failed++;
+                continue;
+            }
+        } else if (romCount > 1 && !dot) {
+            printf("; ==== %s ====\n", romFile);
+        }
+
+        if (dot) {
+            disasm_writeDot(&disasm, baseName(romFile), out);
+        } else {
+            fprintf(out, "; %s: %zu bytes, %u instructions in %u blocks, %u font references\n",
+                    baseName(romFile), romSize, disasm.instructions, disasm.blocks, disasm.fontRefs);
+            disasm_writeListing(&disasm, out);
+        }
+        if (out != stdout) fclose(out);
+    }
+
+    double seconds = analyseNs / 1e9;
+    fprintf(stderr, "%d ROMs, %llu instructions, %llu blocks in %.3f ms (%.1f M instructions/s)\n",
+            romCount - failed, (unsigned long long)instructions, (unsigned long long)blocks,
+            seconds * 1e3, seconds > 0 ? instructions / seconds / 1e6 : 0.0);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+#include <frameshare.h>
+
+// Shared frame segment reader: the example consumer for `--publish`.
+//
+//   framewatch [--seconds N] [--dump SLOT] [--name NAME]
+//
+// Polls every slot once a millisecond and prints, once a second, each active
+// slot's frame counter, frames seen, frames missed and torn copies retried.
+// A slot whose publisher died mid-write is reported as stuck.
+// --dump prints the last frame of SLOT ('.' off, '#' plane 0, 'o' plane 1,
+// '@' both) on exit.
+
+int main(int argc, char** argv) {
+    const char* name = FRAMESHARE_NAME;
+    int seconds = 10;
+    int dumpSlot = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpSlot = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--seconds N] [--dump SLOT] [--name NAME]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (dumpSlot >= FRAMESHARE_SLOTS) dumpSlot = -1;
+
+    FrameShare share;
+    if (!frameshare_attach(&share, name)) return 1;
+
+    static FrameSlot frames[FRAMESHARE_SLOTS];  // last consistent copy per slot
+    uint32_t seen[FRAMESHARE_SLOTS] = {0}, missed[FRAMESHARE_SLOTS] = {0}, torn[FRAMESHARE_SLOTS] = {0};
+    bool stuck[FRAMESHARE_SLOTS] = {0};
+
+    for (int second = 0; second < seconds; second++) {
+        uint64_t end = SDL_GetTicksNS() + SDL_NS_PER_SECOND;
+        while (SDL_GetTicksNS() < end) {
+            for (int s = 0; s < FRAMESHARE_SLOTS; s++) {
+                if (stuck[s]) continue;  // every read would spin out the limit again
+                uint32_t last = frames[s].frame;
+                int retries = frameshare_read(&share, s, &frames[s]);
+                stuck[s] = retries == FRAMESHARE_STUCK;
+                if (retries < 0 || frames[s].frame == last) continue;
+                torn[s] += (uint32_t)retries;
+                seen[s]++;
+                if (last && frames[s].frame > last + 1) missed[s] += frames[s].frame - last - 1;
+            }
+            SDL_Delay(1);
+        }
+        for (int s = 0; s < FRAMESHARE_SLOTS; s++) {
+            if (stuck[s]) {
+                printf("slot %2d: stuck mid-write, its publisher is gone\n", s);
+                stuck[s] = false;  // try it again next second: a new publisher may have taken over
+                continue;
+            }
+            if (!frames[s].frame) continue;
+            printf("slot %2d: frame %8u  %ux%u  seen %u, missed %u, torn %u\n", s, frames[s].frame, frames[s].width,
+                   frames[s].height, seen[s], missed[s], torn[s]);
+            seen[s] = missed[s] = torn[s] = 0;
+        }
+    }
+
+    if (dumpSlot >= 0 && frames[dumpSlot].frame) {
+        const FrameSlot* f = &frames[dumpSlot];
+        for (int y = 0; y < f->height; y++) {
+            for (int x = 0; x < f->width; x++) putchar(".#o@"[frameshare_pixel(f, x, y)]);
+            putchar('\n');
+        }
+    }
+    frameshare_close(&share);
+    return 0;
+}
@@ -0,0 +1,191 @@
+#define CHIP8_QUIET
+
+#include <capture.h>
+#include <chip8.h>
+#include <frameshare.h>
+#include <wav.h>
+
+// Headless runner: no window, no audio device. Time is purely emulated:
+// chip8.hz instruction slots per second, timers ticking every 1/TIMER_HZ.
+//
+//   headless <rom.ch8> [--frames N] [--wav out.wav] [--y4m out.y4m [--scale N]]
+//                      [--profile NAME] [--hz N] [--publish SLOT]
+//
+// Quirks and speed come from the ROM database; --profile / --hz override them.
+//
+// --publish puts every frame in slot SLOT of the shared frame segment (see
+// frameshare.h), for recorders and observers in other processes.
+//
+// The Y4M is 60 fps luma-only, e.g. `ffmpeg -i out.y4m out.mp4`.
+//
+// Built with CHIP8_PROFILE_OPCODES (make PROFILE=1) it also prints per-family
+// opcode counts at exit: [--opcode-sample N] times every Nth instruction,
+// [--opcode-json out.json] writes them as JSON instead of a table.
+//
+// Built with CHIP8_TRACE (make TRACE=1), [--trace out.c8t] logs every
+// instruction in binary; `tracedump out.c8t` prints it.
+
+typedef struct {
+    WavWriter wav;
+    Buzzer buzzer;
+    bool enabled;
+    uint32_t sampleAccumulator;  // remainder of AUDIO_SAMPLE_RATE / chip8.hz per slot
+} AudioRender;
+
+// Emit the samples covering `slots` instruction slots. Keeps the fractional
+// remainder so the output stays sample-accurate with the instruction clock.
+void renderSlots(AudioRender* audio, Chip8* chip8, int slots) {
+    if (!audio->enabled) return;
+    audio->sampleAccumulator += (uint32_t)slots * AUDIO_SAMPLE_RATE;
+    int samples = audio->sampleAccumulator / chip8->hz;
+    audio->sampleAccumulator %= chip8->hz;
+    buzzer_setPattern(&audio->buzzer, chip8->hasAudioPattern ? chip8->audioPattern : NULL, chip8->pitch);
+    wav_writeBuzzer(&audio->wav, &audio->buzzer, samples, chip8->sound_timer > 0);
+}
+
+int main(int argc, char** argv) {
+    const char* romFile = NULL;
+    const char* wavFile = NULL;
+    const char* videoFile = NULL;
+    const char* opcodeJson = NULL;
+    uint32_t opcodeSample = 0;
+    int scale = 1;
+    long frames = TIMER_HZ * 10;
+    int profile = -1;
+    uint16_t hz = 0;
+    int publishSlot = -1;
+    const char* traceFile = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--wav") == 0 && i + 1 < argc) {
+            wavFile = argv[++i];
+        } else if (strcmp(argv[i], "--y4m") == 0 && i + 1 < argc) {
+            videoFile = argv[++i];
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--opcode-json") == 0 && i + 1 < argc) {
+            opcodeJson = argv[++i];
+        } else if (strcmp(argv[i], "--opcode-sample") == 0 && i + 1 < argc) {
+            opcodeSample = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile = chip8_profileByName(argv[++i]);
+            if (profile < 0) {
+                fprintf(stderr, "unknown profile %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc) {
+            hz = (uint16_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (strcmp(argv[i], "--publish") == 0 && i + 1 < argc) {
+            publishSlot = atoi(argv[++i]);
+        } else {
+            romFile = argv[i];
+        }
+    }
+    if (!romFile) {
+        fprintf(stderr,
+                "usage: %s <rom.ch8> [--frames N] [--wav out.wav] [--y4m out.y4m [--scale N]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    Chip8 chip8;
+    chip8_init(&chip8);
+    if (chip8_loadFile(&chip8, romFile) < 0) return 1;
+    if (profile >= 0 || hz) {
+        chip8_setProfile(&chip8, profile >= 0 ? (Chip8Profile)profile : chip8.profile, hz);
+    }
+#ifdef CHIP8_PROFILE_OPCODES
+    chip8.opcodeProfile.sampleInterval = opcodeSample;
+    chip8.opcodeProfile.sampleCountdown = opcodeSample;
+#else
+    if (opcodeJson || opcodeSample) fprintf(stderr, "opcode profiling needs a PROFILE=1 build\n");
+#endif
+#ifdef CHIP8_TRACE
+    static TraceLog trace;  // 16 MB ring
+    if (traceFile) {
+        if (!trace_open(&trace, traceFile)) return 1;
+        chip8.trace = &trace;
+    }
+#else
+    if (traceFile) fprintf(stderr, "tracing needs a TRACE=1 build\n");
+#endif
+
+    AudioRender audio = {0};
+    if (wavFile) {
+        if (!wav_open(&audio.wav, wavFile, AUDIO_SAMPLE_RATE)) return 1;
+        buzzer_init(&audio.buzzer);
+        audio.enabled = true;
+    }
+
+    static Capture capture;  // frame ring is too big for the stack
+    static uint32_t pixels[HIRES_WIDTH * HIRES_HEIGHT];  // chip8_render output for the capture
+    if (videoFile && !capture_open(&capture, videoFile, scale)) return 1;
+    FrameShare share = {0};
+    if (publishSlot >= 0 && !frameshare_open(&share, FRAMESHARE_NAME, publishSlot)) return 1;
+
+    uint64_t start = SDL_GetTicksNS();
+    uint64_t instructions = 0;
+    int slotAccumulator = 0;  // remainder of chip8.hz / TIMER_HZ per frame
+
+    for (long frame = 0; frame < frames; frame++) {
+        slotAccumulator += chip8.hz;
+        int slots = slotAccumulator / TIMER_HZ;
+        slotAccumulator %= TIMER_HZ;
+
+        for (int slot = 0; slot < slots;) {
+            // One slot at a time for the audio; parked on FX0A (no input source
+            // here) or a display wait, chip8_runCycles moves the clock over the
+            // rest of the frame in one go
+            int run = (chip8.waitingForKey || chip8.waitingForVblank) ? slots - slot : 1;
+            instructions += chip8_runCycles(&chip8, run);
+            if (chip8.fault != CHIP8_FAULT_NONE) {
+                fprintf(stderr, "fault at %03X, frame %ld: %s\n", chip8.faultPc, frame, chip8FaultNames[chip8.fault]);
+                renderSlots(&audio, &chip8, slots - slot);
+                frames = frame + 1;  // finish this frame's output, then stop
+                break;
+            }
+            renderSlots(&audio, &chip8, run);
+            slot += run;
+        }
+        chip8_tickTimers(&chip8);
+        if (videoFile) {
+            chip8_render(&chip8, pixels);
+            capture_pushFrame(&capture, pixels);
+        }
+        if (share.slot) frameshare_publish(&share, &chip8);
+    }
+
+    double ms = (SDL_GetTicksNS() - start) / 1e6;  // emulation only, sinks still flushing
+#ifdef CHIP8_TRACE
+    if (chip8.trace) {
+        uint64_t records = trace_close(&trace);
+        printf("traced %llu instructions to %s (emulation waited on the writer %u times)\n",
+               (unsigned long long)records, traceFile, trace.waits);
+    }
+#endif
+
+    if (audio.enabled) wav_close(&audio.wav);
+    frameshare_close(&share);
+    if (videoFile) {
+        capture_close(&capture);
+        printf("captured %u frames (%u repeats, %u dropped)\n",
+               capture.pushed, capture.repeated, capture.dropped);
+    }
+    printf("%ld frames, %llu instructions in %.2f ms (%s profile, %u Hz)\n",
+           frames, (unsigned long long)instructions, ms, chip8Profiles[chip8.profile].name, chip8.hz);
+
+#ifdef CHIP8_PROFILE_OPCODES
+    FILE* stats = opcodeJson ? fopen(opcodeJson, "w") : NULL;
+    if (stats) {
+        opcodeProfile_printJson(&chip8.opcodeProfile, stats);
+        fclose(stats);
+    } else {
+        opcodeProfile_print(&chip8.opcodeProfile, stdout);
+    }
+#endif
+    return 0;
+}
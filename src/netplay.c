@@ -0,0 +1,143 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+#include <netplay.h>
+
+// Rollback netplay soak test: two peers in this process, each with its own
+// Chip8 and UDP socket on 127.0.0.1, talking over a simulated lossy link.
+//
+//   netplay <rom.ch8> [--frames N] [--delay MS] [--loss PCT] [--input-delay N]
+//                     [--port P] [--log out.csv]
+//
+// Player 1 presses keys 0-7 and player 2 keys 8-F, at random but reproducibly.
+// Time is virtual (one frame = 1/TIMER_HZ s), so the delay is exact whatever
+// the host speed. At the end both peers drain the link and their states are
+// compared; the exit code is nonzero on a desync. --log writes one CSV row per
+// peer per frame: rollback depth, re-simulation time and whether it stalled.
+
+#define FRAME_NS (1000000000ull / TIMER_HZ)
+
+typedef struct {
+    uint32_t rng;
+    uint16_t keys;
+    uint8_t firstKey;
+} KeySource;
+
+// Flip one of this player's eight keys about every tenth frame
+uint16_t nextKeys(KeySource* k) {
+    k->rng ^= k->rng << 13;  // xorshift32
+    k->rng ^= k->rng >> 17;
+    k->rng ^= k->rng << 5;
+    if (k->rng % 10 == 0) k->keys ^= 1u << (k->firstKey + (k->rng >> 8) % 8);
+    return k->keys;
+}
+
+void printPeer(int player, const Netplay* n) {
+    printf("player %d: %u frames, %u rollbacks (avg depth %.2f, max %u), %u frames re-simulated, "
+           "%.1f us avg / %.1f us max per rollback, %u stalls, %u packets sent (%u lost)\n",
+           player, n->frame, n->rollbacks, n->rollbacks ? (double)n->resimulated / n->rollbacks : 0.0,
+           n->maxDepth, n->resimulated, n->rollbacks ? n->totalRollbackNs / 1e3 / n->rollbacks : 0.0,
+           n->maxRollbackNs / 1e3, n->stalls, n->net.sent, n->net.lost);
+}
+
+int main(int argc, char** argv) {
+    const char* romFile = "roms/6-keypad.ch8";
+    const char* logFile = NULL;
+    long frames = TIMER_HZ * 10;
+    uint32_t delayMs = 50;
+    uint32_t lossPercent = 5;
+    uint32_t inputDelay = 0;
+    uint16_t port = 7770;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+            delayMs = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+            lossPercent = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc) {
+            inputDelay = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = (uint16_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            logFile = argv[++i];
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr,
+                    "usage: %s <rom.ch8> [--frames N] [--delay MS] [--loss PCT] [--input-delay N] "
+                    "[--port P] [--log out.csv]\n",
+                    argv[0]);
+            return 1;
+        } else {
+            romFile = argv[i];
+        }
+    }
+    if (inputDelay >= NETPLAY_MAX_ROLLBACK) {
+        fprintf(stderr, "--input-delay must be below %d\n", NETPLAY_MAX_ROLLBACK);
+        return 1;
+    }
+
+    static Chip8 chip8;
+    chip8_init(&chip8);
+    if (chip8_loadFile(&chip8, romFile) < 0) return 1;
+
+    static Netplay peers[2];  // a few MB of saved states, too big for the stack
+    KeySource keys[2] = {{0x9E3779B9u, 0, 0}, {0x7F4A7C15u, 0, 8}};
+    for (int p = 0; p < 2; p++) {
+        uint16_t local = (uint16_t)(port + p), remote = (uint16_t)(port + 1 - p);
+        if (!netplay_open(&peers[p], &chip8, local, remote, inputDelay)) return 1;
+        peers[p].net.delayNs = (uint64_t)delayMs * 1000000;
+        peers[p].net.lossPercent = lossPercent;
+        peers[p].net.rng = p ? 0x2545F491u : 0x6C078965u;
+    }
+
+    FILE* log = NULL;
+    if (logFile) {
+        log = fopen(logFile, "w");
+        if (!log) {
+            perror("Failed to create log");
+            return 1;
+        }
+        fprintf(log, "frame,player,rollback_depth,rollback_us,stalled\n");
+    }
+
+    uint64_t now = 0;
+    for (long frame = 0; frame < frames; frame++, now += FRAME_NS) {
+        for (int p = 0; p < 2; p++) {
+            netplay_advance(&peers[p], nextKeys(&keys[p]), now);
+            if (log) {
+                fprintf(log, "%ld,%d,%u,%.1f,%d\n", frame, p + 1, peers[p].rollbackDepth,
+                        peers[p].rollbackNs / 1e3, peers[p].stalled);
+            }
+        }
+    }
+
+    // Drain: let the link deliver everything, catching a stalled peer up to
+    // the other with its keys released, until both run on confirmed input only
+    for (long tick = 0; tick < TIMER_HZ * 60; tick++, now += FRAME_NS) {
+        bool done = true;
+        for (int p = 0; p < 2; p++) {
+            Netplay* n = &peers[p];
+            if (n->frame < peers[1 - p].frame) {
+                netplay_advance(n, 0, now);
+            } else {
+                netplay_poll(n, now);
+            }
+            done = done && netplay_settled(n) && n->frame == peers[1 - p].frame;
+        }
+        if (done) break;
+    }
+    if (log) fclose(log);
+
+    printPeer(1, &peers[0]);
+    printPeer(2, &peers[1]);
+    uint64_t hash[2] = {netplay_stateHash(&peers[0].chip8), netplay_stateHash(&peers[1].chip8)};
+    bool synced = peers[0].frame == peers[1].frame && netplay_settled(&peers[0]) && netplay_settled(&peers[1]) &&
+                  hash[0] == hash[1];
+    printf("%s at frame %u: %016llX / %016llX\n", synced ? "sync OK" : "DESYNC", peers[0].frame,
+           (unsigned long long)hash[0], (unsigned long long)hash[1]);
+
+    netplay_close(&peers[0]);
+    netplay_close(&peers[1]);
+    return synced ? 0 : 1;
+}
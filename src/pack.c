@@ -0,0 +1,197 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+#include <pack.h>
+
+// ROM pack tool: build, inspect and run single-file ROM corpora.
+//
+//   pack create <out.c8pk> [--profile NAME] <rom.ch8>...   (--profile applies to the ROMs after it)
+//   pack list <in.c8pk>
+//   pack run <in.c8pk> [--frames N] [--verbose]
+//
+// Identical ROMs are stored once. `run` maps the pack once and runs every ROM
+// headless, loading each one by index, and reports corpus throughput.
+
+typedef struct {
+    PackEntry entry;
+    uint8_t* data;
+} PendingRom;
+
+int compareEntries(const void* a, const void* b) {
+    const PackEntry* x = &((const PendingRom*)a)->entry;
+    const PackEntry* y = &((const PendingRom*)b)->entry;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return strncmp(x->name, y->name, PACK_NAME_SIZE);
+}
+
+static const char* baseName(const char* path) {
+    const char* name = path;
+    for (const char* c = path; *c; c++) {
+        if (*c == '/' || *c == '\\') name = c + 1;
+    }
+    return name;
+}
+
+int createPack(const char* outFile, int argc, char** argv) {
+    PendingRom* roms = calloc(argc, sizeof(PendingRom));
+    if (!roms) {
+        perror("Failed to allocate index");
+        return 1;
+    }
+    int count = 0;
+    uint16_t profile = 0;  // PackEntry.profile for the ROMs that follow
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            int named = chip8_profileByName(argv[++i]);
+            if (named < 0) fprintf(stderr, "unknown profile %s, using the ROM database\n", argv[i]);
+            profile = (uint16_t)(named + 1);
+            continue;
+        }
+        RomMapping rom;
+        if (!rom_map(&rom, argv[i])) continue;
+        if (rom.size > ROM_MAX_SIZE) {
+            fprintf(stderr, "%s: too large for CHIP-8 memory, skipped\n", argv[i]);
+            rom_unmap(&rom);
+            continue;
+        }
+
+        PendingRom* r = &roms[count];
+        r->data = malloc(rom.size ? rom.size : 1);
+        if (!r->data) {
+            perror("Failed to allocate ROM");
+            rom_unmap(&rom);
+            continue;
+        }
+        if (rom.size) memcpy(r->data, rom.data, rom.size);
+        r->entry.hash = rom_hash(rom.data, rom.size);
+        r->entry.size = (uint32_t)rom.size;
+        r->entry.profile = profile;
+        strncpy(r->entry.name, baseName(argv[i]), PACK_NAME_SIZE - 1);
+        rom_unmap(&rom);
+        count++;
+    }
+    qsort(roms, count, sizeof(PendingRom), compareEntries);
+
+    // Drop duplicate contents (sorted, so they are adjacent)
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (unique && roms[unique - 1].entry.hash == roms[i].entry.hash &&
+            roms[unique - 1].entry.size == roms[i].entry.size) {
+            free(roms[i].data);
+            continue;
+        }
+        roms[unique++] = roms[i];
+    }
+
+    PackHeader header = {0};
+    memcpy(header.magic, PACK_MAGIC, 4);
+    header.version = PACK_VERSION;
+    header.count = unique;
+    header.indexOffset = sizeof(PackHeader);
+    header.dataOffset = header.indexOffset + unique * sizeof(PackEntry);
+
+    uint32_t offset = header.dataOffset;
+    for (int i = 0; i < unique; i++) {
+        roms[i].entry.offset = offset;
+        offset += roms[i].entry.size;
+    }
+
+    // Every write is checked: a short one would leave a pack whose header
+    // and index look fine but whose data ends early
+    FILE* out = fopen(outFile, "wb");
+    bool ok = out != NULL;
+    if (!out) perror("Failed to create pack");
+    ok = ok && fwrite(&header, sizeof(header), 1, out) == 1;
+    for (int i = 0; i < unique; i++) ok = ok && fwrite(&roms[i].entry, sizeof(PackEntry), 1, out) == 1;
+    for (int i = 0; i < unique; i++) {
+        ok = ok && fwrite(roms[i].data, 1, roms[i].entry.size, out) == roms[i].entry.size;
+        free(roms[i].data);
+    }
+    free(roms);
+    if (out) {
+        if (fclose(out) != 0) ok = false;
+        if (!ok) {
+            fprintf(stderr, "Failed to write %s\n", outFile);
+            remove(outFile);
+        }
+    }
+    if (!ok) return 1;
+
+    printf("%s: %d ROMs (%d duplicates dropped), %u bytes\n", outFile, unique, count - unique, offset);
+    return 0;
+}
+
+int listPack(const Pack* pack) {
+    printf("%-16s %6s %-8s  %s\n", "hash", "size", "profile", "name");
+    for (uint32_t i = 0; i < pack->count; i++) {
+        const PackEntry* e = &pack->index[i];
+        const char* profile =
+            (e->profile && e->profile <= CHIP8_PROFILE_COUNT) ? chip8Profiles[e->profile - 1].name : "auto";
+        printf("%016llX %6u %-8s  %.*s\n", (unsigned long long)e->hash, e->size, profile, PACK_NAME_SIZE,
+               e->name);
+    }
+    return 0;
+}
+
+int runPack(const Pack* pack, int frames, bool verbose) {
+    static Chip8 chip8;
+    uint64_t instructions = 0;
+    uint32_t faulted = 0;  // stopped early; the rest of the corpus still runs
+    uint64_t start = SDL_GetTicksNS();
+
+    for (uint32_t i = 0; i < pack->count; i++) {
+        const PackEntry* e = &pack->index[i];
+        chip8_init(&chip8);
+        pack_load(pack, e, &chip8);
+
+        int slotAccumulator = 0;
+        uint64_t executed = 0;
+        for (int frame = 0; frame < frames && !chip8.waitingForKey && !chip8.fault; frame++) {
+            executed += chip8_runFrame(&chip8, &slotAccumulator);
+        }
+        instructions += executed;
+        if (chip8.fault) faulted++;
+        if (verbose) {
+            printf("%016llX %8llu  %.*s%s%s\n", (unsigned long long)e->hash, (unsigned long long)executed,
+                   PACK_NAME_SIZE, e->name, chip8.fault ? "  fault: " : "",
+                   chip8.fault ? chip8FaultNames[chip8.fault] : "");
+        }
+    }
+
+    double seconds = (SDL_GetTicksNS() - start) / 1e9;
+    printf("%u ROMs x %d frames: %llu instructions in %.3f s (%.0f ROMs/s, %.1f M instructions/s), %u faulted\n",
+           pack->count, frames, (unsigned long long)instructions, seconds,
+           seconds > 0 ? pack->count / seconds : 0.0, seconds > 0 ? instructions / seconds / 1e6 : 0.0, faulted);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "create") == 0) {
+        return createPack(argv[2], argc - 3, argv + 3);
+    }
+    if (argc >= 3 && (strcmp(argv[1], "list") == 0 || strcmp(argv[1], "run") == 0)) {
+        int frames = TIMER_HZ;
+        bool verbose = false;
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+                frames = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--verbose") == 0) {
+                verbose = true;
+            }
+        }
+
+        Pack pack;
+        if (!pack_open(&pack, argv[2])) return 1;
+        int result = (argv[1][0] == 'l') ? listPack(&pack) : runPack(&pack, frames, verbose);
+        pack_close(&pack);
+        return result;
+    }
+
+    fprintf(stderr,
+            "usage: %s create <out.c8pk> [--profile NAME] <rom.ch8>...\n"
+            "       %s list <in.c8pk>\n"
+            "       %s run <in.c8pk> [--frames N] [--verbose]\n",
+            argv[0], argv[0], argv[0]);
+    return 1;
+}
@@ -0,0 +1,92 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+#include <profiler.h>
+
+// Guest profiler: runs a ROM headless and reports where the guest spends its
+// instructions.
+//
+//   profile <rom.ch8> [--frames N] [--folded out.folded] [--listing out.txt]
+//
+// The folded output feeds flamegraph.pl directly:
+//   flamegraph.pl out.folded > out.svg
+// The listing is the ROM disassembled with per-instruction counts and
+// inclusive/exclusive totals for each subroutine.
+
+int main(int argc, char** argv) {
+    const char* romFile = NULL;
+    const char* foldedFile = NULL;
+    const char* listingFile = NULL;
+    long frames = TIMER_HZ * 10;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--folded") == 0 && i + 1 < argc) {
+            foldedFile = argv[++i];
+        } else if (strcmp(argv[i], "--listing") == 0 && i + 1 < argc) {
+            listingFile = argv[++i];
+        } else {
+            romFile = argv[i];
+        }
+    }
+    if (!romFile) {
+        fprintf(stderr, "usage: %s <rom.ch8> [--frames N] [--folded out.folded] [--listing out.txt]\n",
+                argv[0]);
+        return 1;
+    }
+
+    static Chip8 chip8;
+    static Profiler profiler;
+    chip8_init(&chip8);
+    int romSize = chip8_loadFile(&chip8, romFile);
+    if (romSize < 0) return 1;
+    profiler_init(&profiler);
+
+    int slotAccumulator = 0;
+    for (long frame = 0; frame < frames; frame++) {
+        slotAccumulator += chip8.hz;
+        int slots = slotAccumulator / TIMER_HZ;
+        slotAccumulator %= TIMER_HZ;
+
+        for (int slot = 0; slot < slots;) {
+            // The profiler sees every instruction before it runs; while parked,
+            // chip8_runCycles moves the clock over the rest of the frame at once
+            bool parked = chip8.waitingForKey || chip8.waitingForVblank;
+            int run = parked ? slots - slot : 1;
+            if (!parked) profiler_step(&profiler, &chip8);
+            chip8_runCycles(&chip8, run);
+            if (chip8.fault != CHIP8_FAULT_NONE) {
+                fprintf(stderr, "fault at %03X, frame %ld: %s\n", chip8.faultPc, frame, chip8FaultNames[chip8.fault]);
+                frames = frame + 1;
+                break;
+            }
+            slot += run;
+        }
+        chip8_tickTimers(&chip8);
+    }
+
+    FILE* folded = foldedFile ? fopen(foldedFile, "w") : stdout;
+    if (!folded) {
+        perror("Failed to open folded output");
+        return 1;
+    }
+    profiler_writeFolded(&profiler, folded);
+    if (folded != stdout) fclose(folded);
+
+    if (listingFile) {
+        FILE* listing = fopen(listingFile, "w");
+        if (!listing) {
+            perror("Failed to open listing output");
+            return 1;
+        }
+        profiler_writeListing(&profiler, &chip8, 0x200, 0x200 + romSize, listing);
+        fclose(listing);
+    }
+
+    if (profiler.overflow) {
+        fprintf(stderr, "%llu calls not attributed (call tree full)\n",
+                (unsigned long long)profiler.overflow);
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#define CHIP8_QUIET
+
+#include <chip8.h>
+
+// Instruction trace decoder: turns the binary records of a TRACE=1 build's
+// --trace file back into the mnemonics chip8Cycle would have printed.
+//
+//   tracedump <trace.c8t> [--from CLOCK] [--count N] [--pc ADDR]
+//
+// One line per instruction: emulated clock, address, opcode, mnemonic and the
+// register it changed. --from skips records before an emulated clock, --pc
+// (hex) keeps only one address, --count stops after N printed lines.
+
+int main(int argc, char** argv) {
+    const char* traceFile = NULL;
+    uint64_t from = 0;
+    uint64_t count = UINT64_MAX;
+    int onlyPc = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--pc") == 0 && i + 1 < argc) {
+            onlyPc = (int)strtol(argv[++i], NULL, 16);
+        } else {
+            traceFile = argv[i];
+        }
+    }
+    if (!traceFile) {
+        fprintf(stderr, "usage: %s <trace.c8t> [--from CLOCK] [--count N] [--pc ADDR]\n", argv[0]);
+        return 1;
+    }
+
+    RomMapping file;
+    if (!rom_map(&file, traceFile)) return 1;
+    const TraceHeader* header = (const TraceHeader*)file.data;
+    if (file.size < sizeof(TraceHeader) || memcmp(header->magic, TRACE_MAGIC, 4) != 0 ||
+        header->version != TRACE_VERSION || header->recordSize != sizeof(TraceRecord)) {
+        fprintf(stderr, "%s: not a version %d trace\n", traceFile, TRACE_VERSION);
+        rom_unmap(&file);
+        return 1;
+    }
+    const TraceRecord* records = (const TraceRecord*)(file.data + sizeof(TraceHeader));
+    size_t total = (file.size - sizeof(TraceHeader)) / sizeof(TraceRecord);
+
+    uint64_t printed = 0;
+    for (size_t i = 0; i < total && printed < count; i++) {
+        const TraceRecord* r = &records[i];
+        if (r->clock < from || (onlyPc >= 0 && r->pc != onlyPc)) continue;
+
+        char text[32];
+        opcode_format(r->opcode, text, sizeof(text));
+        char note[64] = "";
+        if (r->fault) {
+            snprintf(note, sizeof(note), "fault: %s",
+                     r->fault < CHIP8_FAULT_COUNT ? chip8FaultNames[r->fault] : "unknown");
+        } else if (r->reg < 16) {
+            snprintf(note, sizeof(note), "V%X = %02X", r->reg, r->value);
+        } else if (r->reg == TRACE_REG_I) {
+            snprintf(note, sizeof(note), "I = %04X", r->value);
+        }
+        if (note[0]) {
+            printf("%12llu  %03X  %04X  %-22s ; %s\n", (unsigned long long)r->clock, r->pc, r->opcode, text, note);
+        } else {
+            printf("%12llu  %03X  %04X  %s\n", (unsigned long long)r->clock, r->pc, r->opcode, text);
+        }
+        printed++;
+    }
+
+    fprintf(stderr, "%zu records", total);
+    if (total) {
+        fprintf(stderr, ", clock %llu..%llu", (unsigned long long)records[0].clock,
+                (unsigned long long)records[total - 1].clock);
+    }
+    fprintf(stderr, ", %llu printed\n", (unsigned long long)printed);
+    rom_unmap(&file);
+    return 0;
+}